@@ -17,6 +17,7 @@ BuildRequires:	pkgconfig(sqlite3)
 BuildRequires:	pkgconfig(libcurl)
 BuildRequires:	pkgconfig(webkit2gtk-4.0)
 BuildRequires:	pkgconfig(libxml-2.0)
+BuildRequires:	pkgconfig(zlib)
 BuildRequires:  pkgconfig(appstream-glib)
 Requires:	gtk3 sqlite curl webkit2gtk4.0 libxml2
 
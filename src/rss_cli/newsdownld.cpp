@@ -14,7 +14,13 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <iostream>
 #include <vector>
 #include <map>
+#include <atomic>
+#include <memory>
+#include <thread>
 
+#include <signal.h>
+
+#include "rss_lib/db/db.hpp"
 #include "rss_lib/rss/rss_writer.hpp"
 #include "rss_lib/rss/rss_reader.hpp"
 #include "rss_lib/rss/rss_feed.hpp"
@@ -27,6 +33,71 @@ namespace {
 	int
 	cleanup_argtable (void** argtable, int exit_code);
 
+	/*
+		SQL PROFILE ON DEMAND
+
+		With --profile-sql, kill -USR1 <pid> prints the statement profiles gathered so far.
+
+		SIGUSR1 is blocked in every thread and taken by sigwait on the watch thread,
+		so the report is printed outside of signal context. get_statement_profiles copies
+		the profiles under their lock, so statements go on being timed while it prints.
+	*/
+	class profile_signal_watch
+	{
+		public:
+			profile_signal_watch();
+			~profile_signal_watch();
+
+		private:
+			std::atomic_bool stop_requested = false;
+			std::thread thread;
+
+			void
+			run();
+	};
+
+	/*
+		Call before any other thread starts. Threads started later inherit the blocked signal.
+	*/
+	profile_signal_watch::profile_signal_watch()
+	{
+		sigset_t signals;
+
+		sigemptyset (&signals);
+		sigaddset (&signals, SIGUSR1);
+
+		pthread_sigmask (SIG_BLOCK, &signals, nullptr);
+
+		thread = std::thread (&profile_signal_watch::run, this);
+	}
+
+	profile_signal_watch::~profile_signal_watch()
+	{
+		stop_requested = true;
+
+		/*Wakes the watch thread from sigwait.*/
+		pthread_kill (thread.native_handle(), SIGUSR1);
+
+		thread.join();
+	}
+
+	void
+	profile_signal_watch::run()
+	{
+		sigset_t signals;
+
+		sigemptyset (&signals);
+		sigaddset (&signals, SIGUSR1);
+
+		int signal_number = 0;
+
+		while (sigwait (&signals, &signal_number) == 0 && stop_requested == false) {
+			gautier_rss_database::print_statement_profiles();
+		}
+
+		return;
+	}
+
 	int
 	cleanup_argtable (void** argtable, int exit_code)
 	{
@@ -112,6 +183,23 @@ main (int argc, char** argv)
 	*/
 	struct arg_lit* cli_check_time_limit;
 
+	/*
+		Stored article search
+	*/
+	struct arg_str* cli_search_text;
+
+	/*
+		Article storage
+	*/
+	struct arg_lit* cli_no_compress;
+	struct arg_lit* cli_op_recompress;
+
+	/*
+		Database maintenance
+	*/
+	struct arg_lit* cli_op_vacuum;
+	struct arg_lit* cli_profile_sql;
+
 	/*
 		Linux command-line program minimum options.
 	*/
@@ -150,6 +238,14 @@ main (int argc, char** argv)
 		cli_datetime1		= arg_strn (nullptr, "datetime1", "<string>", 0, 1, "datetime-1"),
 		cli_datetime2		= arg_strn (nullptr, "datetime2", "<string>", 0, 1, "datetime-2"),
 
+		cli_search_text		= arg_strn (nullptr, "search", "<string>", 0, 1, "Full text search of stored articles"),
+
+		cli_no_compress		= arg_litn (nullptr, "no-compress", 0, 1, "Store article summary and text uncompressed"),
+		cli_op_recompress	= arg_litn (nullptr, "recompress", 0, 1, "Rewrite stored articles with the current compression setting"),
+
+		cli_op_vacuum		= arg_litn (nullptr, "vacuum", 0, 1, "Rebuild the database file to reclaim all unused space"),
+		cli_profile_sql		= arg_litn (nullptr, "profile-sql", 0, 1, "Time each SQL statement and print a report before exit and on SIGUSR1"),
+
 		/*
 			TABLE END
 		*/
@@ -217,10 +313,31 @@ main (int argc, char** argv)
 		}
 	}
 
+	const bool profile_sql = cli_profile_sql->count > 0;
+
+	std::unique_ptr<profile_signal_watch> profile_watch;
+
+	if (profile_sql) {
+		gautier_rss_database::set_statement_profiling (true);
+
+		profile_watch = std::make_unique<profile_signal_watch>();
+	}
+
 	if (db_file_name.empty() == false) {
 		std::cout << "Open database: " << db_file_name << "\n";
 
 		ns_write::initialize_db (db_file_name);
+
+		/*
+			Commits run in the background while the next feed downloads.
+		*/
+		const int64_t max_commit_delay_in_milliseconds = 50;
+
+		ns_write::start_write_queue (db_file_name, max_commit_delay_in_milliseconds);
+	}
+
+	if (cli_no_compress->count > 0) {
+		ns_write::set_article_compression (false);
 	}
 
 	std::string feed_name;
@@ -373,6 +490,52 @@ main (int argc, char** argv)
 		}
 	}
 
+	/*
+		Rewrite stored articles. Combine with --no-compress to expand them.
+	*/
+
+	else if (cli_op_recompress->count > 0) {
+		std::cout << "Rewrite stored articles\n";
+
+		ns_write::recompress_articles (db_file_name);
+
+		if (verbose) {
+			std::cout << "Article rewrite finished.\n";
+		}
+	}
+
+	/*
+		Rebuild the database file. Routine upkeep runs in short slices at the end of every run.
+	*/
+
+	else if (cli_op_vacuum->count > 0) {
+		std::cout << "Rebuild database file\n";
+
+		ns_write::vacuum_db (db_file_name);
+
+		if (verbose) {
+			std::cout << "Database rebuild finished.\n";
+		}
+	}
+
+	/*
+		Search stored articles.
+	*/
+
+	else if (cli_search_text->count > 0) {
+		const std::string search_text = *cli_search_text->sval;
+
+		ns_read::articles_list_type articles;
+
+		ns_read::search_articles (db_file_name, search_text, 0, 20, articles);
+
+		std::cout << "Articles matching: " << search_text << "\n";
+
+		for (const ns_read::rss_article& article : articles) {
+			std::cout << article.feed_name << " | " << article.headline << " | " << article.url << "\n";
+		}
+	}
+
 	/*
 		Get Seconds from two dates times.
 	*/
@@ -411,10 +574,36 @@ main (int argc, char** argv)
 		return cleanup_argtable (argtable, exit_code);
 	}
 
+	if (verbose && db_file_name.empty() == false) {
+		namespace ns_db = gautier_rss_database;
+
+		const ns_db::sql_statement_cache_stats cache_stats = ns_db::get_statement_cache_stats (db_file_name);
+
+		std::cout << "SQL statement cache: " << cache_stats.statement_count << " statements, "
+		          << cache_stats.hits << " hits, " << cache_stats.misses << " misses\n";
+	}
+
+	/*
+		Routine database upkeep, bounded so a scheduled run stays short.
+		Whatever does not fit is picked up by a later run.
+	*/
 	if (db_file_name.empty() == false) {
+		const int64_t maintenance_time_budget_in_milliseconds = 250;
+
+		const bool maintenance_complete = ns_write::perform_db_maintenance (db_file_name,
+		                                  maintenance_time_budget_in_milliseconds);
+
+		if (verbose) {
+			std::cout << "Database maintenance " << (maintenance_complete ? "complete" : "partially complete") << "\n";
+		}
+
 		ns_write::de_initialize_db (db_file_name);
 	}
 
+	if (profile_sql) {
+		gautier_rss_database::print_statement_profiles();
+	}
+
 	exit_code = 0;
 
 	return cleanup_argtable (argtable, exit_code);
@@ -10,10 +10,22 @@ You should have received a copy of the GNU Lesser General Public License along w
 Author: Michael Gautier <michaelgautier.wordpress.com>
 */
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
+#include <malloc.h>
+
+#include "libxml/xmlmemory.h"
+
+#include "rss_lib/db/db.hpp"
 #include "rss_lib/rss/rss_feed.hpp"
 #include "rss_lib/rss/rss_reader.hpp"
+#include "rss_lib/rss/rss_util.hpp"
 #include "rss_lib/rss/rss_writer.hpp"
 #include "rss_lib/rss_parse/feed_parse.hpp"
 #include "rss_lib/rss_download/feed_download.hpp"
@@ -30,6 +42,33 @@ namespace {
 	int
 	cleanup_argtable (void** argtable, int exit_code);
 
+	int_fast32_t
+	get_time_difference_in_seconds_sqlite (const std::string date1, const std::string date2);
+
+	void
+	benchmark_date_time (const int feed_count);
+
+	void
+	convert_chars_to_lower_case_string_baseline (const char* chars, std::string& str);
+
+	bool
+	convert_chars_to_int_string_baseline (const char* chars, std::string& str);
+
+	void
+	benchmark_text_kernels (const int text_count, const int repeat_count);
+
+	void
+	create_benchmark_feed (const int item_count, const int nesting_depth, std::string& feed_data);
+
+	void
+	benchmark_feed_parse (const int item_count, const int nesting_depth, const int repeat_count);
+
+	void
+	benchmark_feed_download (const std::string feed_url, const int repeat_count);
+
+	void
+	benchmark_parse_many_feeds (const int feed_count, const int item_count, const int repeat_count);
+
 	void
 	flatten_rss_xml_to_text (std::string feed_name)
 	{
@@ -73,6 +112,711 @@ namespace {
 		return;
 	}
 
+	/*
+		The earlier implementation of get_time_difference_in_seconds, kept as the benchmark baseline.
+	*/
+	int_fast32_t
+	get_time_difference_in_seconds_sqlite (const std::string date1, const std::string date2)
+	{
+		namespace ns_db = gautier_rss_database;
+
+		int_fast32_t seconds = 0;
+
+		sqlite3* db = nullptr;
+		ns_db::open_db (":memory:", &db);
+
+		ns_db::sql_rowset_type rows;
+		const std::string sql_text = "SELECT ABS(STRFTIME('%s', @date1) - strftime('%s', @date2)) AS result;";
+
+		ns_db::sql_parameter_list_type params = {
+			date1.empty() ? gautier_rss_util::get_current_date_time_utc() : date1,
+			date2.empty() ? gautier_rss_util::get_current_date_time_utc() : date2
+		};
+
+		ns_db::process_sql (&db, sql_text, params, rows);
+
+		for (ns_db::sql_row_type row : rows) {
+			const std::string result = row["result"];
+
+			if (result.empty() == false) {
+				seconds = std::stoi (result);
+			}
+		}
+
+		ns_db::close_db (&db);
+
+		return seconds;
+	}
+
+	/*
+		Times the feed freshness check for feed_count feeds, first with the SQLite
+		date arithmetic and then with the native date functions. Both must agree.
+	*/
+	void
+	benchmark_date_time (const int feed_count)
+	{
+		namespace ns_read = gautier_rss_data_read;
+
+		std::vector<ns_read::rss_feed> feeds (feed_count);
+
+		const int64_t now = gautier_rss_util::get_current_epoch_seconds();
+
+		for (int i = 0; i < feed_count; i++) {
+			ns_read::rss_feed* feed = &feeds[i];
+
+			feed->feed_name = "feed " + std::to_string (i);
+			feed->retrieve_limit_hrs = std::to_string (1 + (i % 4));
+
+			gautier_rss_util::format_date_time (now - (i * 37) % 18000, feed->last_retrieved);
+		}
+
+		int64_t fresh_count_sqlite = 0;
+		int64_t fresh_count_native = 0;
+
+		const std::chrono::steady_clock::time_point sqlite_start = std::chrono::steady_clock::now();
+
+		for (const ns_read::rss_feed& feed : feeds) {
+			const int_fast32_t seconds_elapsed = get_time_difference_in_seconds_sqlite ("", feed.last_retrieved);
+
+			fresh_count_sqlite += (seconds_elapsed <= std::stoi (feed.retrieve_limit_hrs) * 3600);
+		}
+
+		const std::chrono::steady_clock::time_point native_start = std::chrono::steady_clock::now();
+
+		for (const ns_read::rss_feed& feed : feeds) {
+			fresh_count_native += ns_read::is_feed_still_fresh (feed, false);
+		}
+
+		const std::chrono::steady_clock::time_point native_end = std::chrono::steady_clock::now();
+
+		const int64_t sqlite_microseconds = std::chrono::duration_cast<std::chrono::microseconds>
+		                                    (native_start - sqlite_start).count();
+		const int64_t native_microseconds = std::chrono::duration_cast<std::chrono::microseconds>
+		                                    (native_end - native_start).count();
+
+		std::cout << "Freshness check for " << feed_count << " feeds\n";
+		std::cout << "\tSQLite date arithmetic:\t" << sqlite_microseconds << " us\t(" << fresh_count_sqlite << " fresh)\n";
+		std::cout << "\tNative date arithmetic:\t" << native_microseconds << " us\t(" << fresh_count_native << " fresh)\n";
+
+		if (fresh_count_sqlite != fresh_count_native) {
+			std::cout << "ERROR: results differ\n";
+		}
+
+		return;
+	}
+
+	/*
+		The earlier char at a time implementations, kept as the benchmark baseline.
+	*/
+	void
+	convert_chars_to_lower_case_string_baseline (const char* chars, std::string& str)
+	{
+		const std::string detail = chars;
+		const size_t char_count = detail.size();
+
+		for (size_t char_index = 0; char_index < char_count; char_index++) {
+			const char character = detail.at (char_index);
+
+			str.push_back ((char) (std::tolower (character)));
+		}
+
+		return;
+	}
+
+	bool
+	convert_chars_to_int_string_baseline (const char* chars, std::string& str)
+	{
+		const std::string detail = chars;
+		const size_t char_count = detail.size();
+
+		for (size_t char_index = 0; char_index < char_count; char_index++) {
+			const char character = detail.at (char_index);
+
+			if (std::isdigit (character)) {
+				str.push_back ((char) (character));
+			}
+		}
+
+		return (str.empty() == false);
+	}
+
+	/*
+		Times lower case, digit, trim and compare over a mix of feed element names and
+		headline length text, first with the char at a time code and then with the text kernels.
+		Every result is compared between the two.
+	*/
+	void
+	benchmark_text_kernels (const int text_count, const int repeat_count)
+	{
+		const std::vector<std::string> element_names = {
+			"item", "entry", "title", "link", "pubDate", "published", "updated", "dc:date",
+			"description", "summary", "content", "content:encoded", "guid", "CATEGORY"
+		};
+
+		std::vector<std::string> texts;
+
+		uint32_t seed = 2463534242u;
+
+		for (int i = 0; i < text_count; i++) {
+			if (i % 2 == 0) {
+				texts.emplace_back (element_names[(size_t) (i / 2) % element_names.size()]);
+				continue;
+			}
+
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+
+			const size_t char_count = 16 + seed % 240;
+
+			std::string text = (seed % 3 == 0) ? " \t\n  " : "";
+
+			for (size_t char_index = 0; char_index < char_count; char_index++) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+
+				const std::string_view alphabet = "abcXYZ 0123456789 Jan,Feb: The quick BROWN fox\xc3\xa9";
+
+				text.push_back (alphabet[seed % alphabet.size()]);
+			}
+
+			if (seed % 5 == 0) {
+				text.append ("  \r\n");
+			}
+
+			texts.emplace_back (std::move (text));
+		}
+
+		std::vector<std::string> texts_upper;
+
+		for (const std::string& text : texts) {
+			std::string text_upper;
+
+			for (const char character : text) {
+				text_upper.push_back ((char) (std::toupper ((unsigned char) (character))));
+			}
+
+			texts_upper.emplace_back (std::move (text_upper));
+		}
+
+		int64_t mismatch_count = 0;
+
+		/*
+			Correctness
+		*/
+		{
+			std::string expected;
+			std::string actual;
+
+			for (size_t i = 0; i < texts.size(); i++) {
+				const std::string& text = texts[i];
+
+				expected.clear();
+				convert_chars_to_lower_case_string_baseline (text.data(), expected);
+				gautier_rss_util::convert_to_lower_case (text, actual);
+				mismatch_count += (expected != actual);
+
+				expected.clear();
+				convert_chars_to_int_string_baseline (text.data(), expected);
+				gautier_rss_util::copy_digits (text, actual);
+				mismatch_count += (expected != actual);
+
+				const size_t start_index = text.find_first_not_of (" \t\n\v\f\r");
+				const size_t end_index = text.find_last_not_of (" \t\n\v\f\r");
+				const std::string_view trimmed = (start_index == std::string::npos) ? std::string_view() :
+				                                 std::string_view (text).substr (start_index, end_index - start_index + 1);
+				mismatch_count += (trimmed != gautier_rss_util::trim_white_space (text));
+
+				mismatch_count += (gautier_rss_util::equals_ignore_case (text, texts_upper[i]) == false);
+				mismatch_count += (i > 0 && gautier_rss_util::equals_ignore_case (text, texts[i - 1]) && text != texts[i - 1]);
+			}
+		}
+
+		int64_t checksum_baseline = 0;
+		int64_t checksum_kernel = 0;
+
+		std::chrono::steady_clock::time_point start_time;
+
+		auto get_microseconds = [&start_time]() {
+			return std::chrono::duration_cast<std::chrono::microseconds>
+			       (std::chrono::steady_clock::now() - start_time).count();
+		};
+
+		std::cout << "Text kernels, " << texts.size() << " texts x " << repeat_count << "\n";
+
+		/*Lower case*/
+		{
+			start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (const std::string& text : texts) {
+					std::string lower_case_text;
+
+					convert_chars_to_lower_case_string_baseline (text.data(), lower_case_text);
+
+					checksum_baseline += (int64_t) (lower_case_text.size());
+				}
+			}
+
+			const int64_t baseline_microseconds = get_microseconds();
+
+			start_time = std::chrono::steady_clock::now();
+
+			std::string lower_case_text;
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (const std::string& text : texts) {
+					gautier_rss_util::convert_to_lower_case (text, lower_case_text);
+
+					checksum_kernel += (int64_t) (lower_case_text.size());
+				}
+			}
+
+			std::cout << "\tLower case:\t" << baseline_microseconds << " us -> " << get_microseconds() << " us\n";
+		}
+
+		/*Digits*/
+		{
+			start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (const std::string& text : texts) {
+					std::string digits;
+
+					convert_chars_to_int_string_baseline (text.data(), digits);
+
+					checksum_baseline += (int64_t) (digits.size());
+				}
+			}
+
+			const int64_t baseline_microseconds = get_microseconds();
+
+			start_time = std::chrono::steady_clock::now();
+
+			std::string digits;
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (const std::string& text : texts) {
+					gautier_rss_util::copy_digits (text, digits);
+
+					checksum_kernel += (int64_t) (digits.size());
+				}
+			}
+
+			std::cout << "\tDigits:\t\t" << baseline_microseconds << " us -> " << get_microseconds() << " us\n";
+		}
+
+		/*Trim*/
+		{
+			start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (const std::string& text : texts) {
+					std::string_view trimmed = text;
+
+					while (trimmed.empty() == false && std::isspace ((unsigned char) (trimmed.front()))) {
+						trimmed.remove_prefix (1);
+					}
+
+					while (trimmed.empty() == false && std::isspace ((unsigned char) (trimmed.back()))) {
+						trimmed.remove_suffix (1);
+					}
+
+					checksum_baseline += (int64_t) (trimmed.size());
+				}
+			}
+
+			const int64_t baseline_microseconds = get_microseconds();
+
+			start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (const std::string& text : texts) {
+					checksum_kernel += (int64_t) (gautier_rss_util::trim_white_space (text).size());
+				}
+			}
+
+			std::cout << "\tTrim:\t\t" << baseline_microseconds << " us -> " << get_microseconds() << " us\n";
+		}
+
+		/*Case insensitive compare*/
+		{
+			start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (size_t i = 0; i < texts.size(); i++) {
+					const std::string& text1 = texts[i];
+					const std::string& text2 = texts_upper[i];
+
+					bool is_equal = (text1.size() == text2.size());
+
+					for (size_t char_index = 0; is_equal && char_index < text1.size(); char_index++) {
+						is_equal = (std::tolower ((unsigned char) (text1[char_index])) ==
+						            std::tolower ((unsigned char) (text2[char_index])));
+					}
+
+					checksum_baseline += is_equal;
+				}
+			}
+
+			const int64_t baseline_microseconds = get_microseconds();
+
+			start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				for (size_t i = 0; i < texts.size(); i++) {
+					checksum_kernel += gautier_rss_util::equals_ignore_case (texts[i], texts_upper[i]);
+				}
+			}
+
+			std::cout << "\tCompare:\t" << baseline_microseconds << " us -> " << get_microseconds() << " us\n";
+		}
+
+		if (mismatch_count > 0 || checksum_baseline != checksum_kernel) {
+			std::cout << "ERROR: results differ (" << mismatch_count << " mismatches)\n";
+		}
+
+		return;
+	}
+
+	/*
+		libxml2 heap accounting for the parse benchmark.
+	*/
+	int64_t
+	libxml_heap_bytes = 0;
+
+	int64_t
+	libxml_heap_peak_bytes = 0;
+
+	void*
+	libxml_malloc (size_t size)
+	{
+		void* block = malloc (size);
+
+		if (block) {
+			libxml_heap_bytes += (int64_t) (malloc_usable_size (block));
+			libxml_heap_peak_bytes = std::max (libxml_heap_peak_bytes, libxml_heap_bytes);
+		}
+
+		return block;
+	}
+
+	void
+	libxml_free (void* block)
+	{
+		if (block) {
+			libxml_heap_bytes -= (int64_t) (malloc_usable_size (block));
+		}
+
+		free (block);
+
+		return;
+	}
+
+	void*
+	libxml_realloc (void* block, size_t size)
+	{
+		const int64_t block_size = block ? (int64_t) (malloc_usable_size (block)) : 0;
+
+		void* new_block = realloc (block, size);
+
+		if (new_block) {
+			libxml_heap_bytes += (int64_t) (malloc_usable_size (new_block)) - block_size;
+			libxml_heap_peak_bytes = std::max (libxml_heap_peak_bytes, libxml_heap_bytes);
+		}
+
+		return new_block;
+	}
+
+	char*
+	libxml_strdup (const char* text)
+	{
+		const size_t size = strlen (text) + 1;
+
+		char* copy = (char*) (libxml_malloc (size));
+
+		if (copy) {
+			memcpy (copy, text, size);
+		}
+
+		return copy;
+	}
+
+	/*
+		RSS feed of item_count items. With a nesting_depth above 0 each item also carries
+		an Atom style xhtml content element with that many nested div elements.
+	*/
+	void
+	create_benchmark_feed (const int item_count, const int nesting_depth, std::string& feed_data)
+	{
+		feed_data = "<?xml version=\"1.0\"?>\n<rss version=\"2.0\" "
+		            "xmlns:content=\"http://purl.org/rss/1.0/modules/content/\" "
+		            "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" "
+		            "xmlns:atom=\"http://www.w3.org/2005/Atom\">\n<channel>\n"
+		            "<title>Benchmark</title>\n<link>http://example.com/</link>\n";
+
+		for (int i = 0; i < item_count; i++) {
+			const std::string n = std::to_string (i);
+
+			feed_data.append ("<item>\n\t<title>Headline &amp; number " + n + "</title>\n");
+			feed_data.append ("\t<link>http://example.com/article/" + n + "</link>\n");
+			feed_data.append ("\t<dc:date>2024-01-01T10:00:00Z</dc:date>\n");
+			feed_data.append ("\t<description>Summary of article " + n + "</description>\n");
+
+			if (nesting_depth > 0) {
+				feed_data.append ("\t<atom:content type=\"xhtml\">");
+
+				for (int depth = 0; depth < nesting_depth; depth++) {
+					feed_data.append ("<div>text " + std::to_string (depth) + " ");
+				}
+
+				for (int depth = 0; depth < nesting_depth; depth++) {
+					feed_data.append ("</div>");
+				}
+
+				feed_data.append ("</atom:content>\n</item>\n");
+				continue;
+			}
+
+			feed_data.append ("\t<content:encoded><![CDATA[<p>");
+
+			for (int word = 0; word < 150; word++) {
+				feed_data.append ("text ");
+			}
+
+			feed_data.append (n + "</p>]]></content:encoded>\n</item>\n");
+		}
+
+		feed_data.append ("</channel>\n</rss>\n");
+
+		return;
+	}
+
+	/*
+		Parses a generated RSS feed in each parse mode.
+		Reports the time per parse and the peak libxml2 heap, and checks both modes produce the same articles.
+	*/
+	void
+	benchmark_feed_parse (const int item_count, const int nesting_depth, const int repeat_count)
+	{
+		namespace ns_read = gautier_rss_data_read;
+
+		namespace ns_parse = gautier_rss_data_parse;
+
+		xmlMemSetup (libxml_free, libxml_malloc, libxml_realloc, libxml_strdup);
+
+		std::string feed_data;
+
+		create_benchmark_feed (item_count, nesting_depth, feed_data);
+
+		std::cout << "Feed parse, " << item_count << " items, nesting depth " << nesting_depth << ", "
+		          << feed_data.size() / 1024 << " KB x " << repeat_count << "\n";
+
+		std::vector<ns_read::rss_article> articles_by_mode[2];
+
+		const ns_parse::feed_parse_mode parse_modes[2] = {
+			ns_parse::feed_parse_mode::document,
+			ns_parse::feed_parse_mode::stream
+		};
+
+		const char* mode_names[2] = {"Document", "Stream"};
+
+		for (int mode_index = 0; mode_index < 2; mode_index++) {
+			libxml_heap_peak_bytes = libxml_heap_bytes;
+
+			const int64_t heap_start_bytes = libxml_heap_bytes;
+
+			const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				std::vector<ns_read::rss_article>& articles = articles_by_mode[mode_index];
+
+				articles.clear();
+
+				ns_parse::get_feed_lines (feed_data, articles, parse_modes[mode_index]);
+			}
+
+			const int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>
+			                             (std::chrono::steady_clock::now() - start_time).count();
+
+			std::cout << "\t" << mode_names[mode_index] << ":\t" << microseconds / repeat_count << " us per parse\t"
+			          << (libxml_heap_peak_bytes - heap_start_bytes) / 1024 << " KB peak libxml2 heap\t"
+			          << articles_by_mode[mode_index].size() << " articles\n";
+		}
+
+		bool is_same = (articles_by_mode[0].size() == articles_by_mode[1].size());
+
+		for (size_t i = 0; is_same && i < articles_by_mode[0].size(); i++) {
+			const ns_read::rss_article& article1 = articles_by_mode[0][i];
+			const ns_read::rss_article& article2 = articles_by_mode[1][i];
+
+			is_same = (article1.headline == article2.headline && article1.url == article2.url &&
+			           article1.article_date == article2.article_date &&
+			           article1.article_summary == article2.article_summary &&
+			           article1.article_text == article2.article_text);
+		}
+
+		if (is_same == false) {
+			std::cout << "ERROR: results differ\n";
+		}
+
+		return;
+	}
+
+	/*
+		Times download then parse against parsing while the download is in progress.
+	*/
+	void
+	benchmark_feed_download (const std::string feed_url, const int repeat_count)
+	{
+		namespace ns_read = gautier_rss_data_read;
+
+		namespace ns_parse = gautier_rss_data_parse;
+
+		ns_read::initialize_network();
+
+		size_t article_count_buffered = 0;
+		size_t article_count_pipelined = 0;
+
+		int64_t microseconds_buffered = 0;
+		int64_t microseconds_pipelined = 0;
+
+		for (int repeat = 0; repeat < repeat_count; repeat++) {
+			/*Download, then parse*/
+			{
+				const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+				std::string feed_data;
+
+				ns_read::download_rss_feed (feed_url, feed_data);
+
+				std::vector<ns_read::rss_article> feed_lines;
+
+				ns_parse::get_feed_lines (feed_data, feed_lines);
+
+				microseconds_buffered += std::chrono::duration_cast<std::chrono::microseconds>
+				                         (std::chrono::steady_clock::now() - start_time).count();
+
+				article_count_buffered = feed_lines.size();
+			}
+
+			/*Parse during the download*/
+			{
+				const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+				std::vector<ns_read::rss_article> feed_lines;
+
+				ns_parse::feed_parse_stream parse_stream;
+
+				ns_parse::open_feed_parse_stream (feed_lines, parse_stream);
+
+				ns_read::download_rss_feed (feed_url, [&parse_stream] (std::string_view feed_data) {
+					return ns_parse::write_feed_parse_stream (parse_stream, feed_data);
+				});
+
+				ns_parse::close_feed_parse_stream (parse_stream);
+
+				microseconds_pipelined += std::chrono::duration_cast<std::chrono::microseconds>
+				                          (std::chrono::steady_clock::now() - start_time).count();
+
+				article_count_pipelined = feed_lines.size();
+			}
+		}
+
+		ns_read::de_initialize_network();
+
+		std::cout << "Feed download and parse, " << feed_url << " x " << repeat_count << "\n";
+		std::cout << "\tDownload, then parse:\t" << microseconds_buffered / repeat_count << " us\t("
+		          << article_count_buffered << " articles)\n";
+		std::cout << "\tParse during download:\t" << microseconds_pipelined / repeat_count << " us\t("
+		          << article_count_pipelined << " articles)\n";
+
+		if (article_count_buffered != article_count_pipelined) {
+			std::cout << "ERROR: results differ\n";
+		}
+
+		return;
+	}
+
+	/*
+		Parses a batch of generated feeds on 1 thread, then on more threads.
+		Checks every thread count produces the same articles as 1 thread.
+	*/
+	void
+	benchmark_parse_many_feeds (const int feed_count, const int item_count, const int repeat_count)
+	{
+		namespace ns_read = gautier_rss_data_read;
+
+		namespace ns_parse = gautier_rss_data_parse;
+
+		std::vector<std::string> feed_texts (feed_count);
+
+		std::vector<std::string_view> feed_data;
+
+		for (std::string& feed_text : feed_texts) {
+			create_benchmark_feed (item_count, 0, feed_text);
+
+			feed_data.emplace_back (feed_text);
+		}
+
+		std::cout << "Parse many feeds, " << feed_count << " feeds of " << item_count << " items x " << repeat_count
+		          << ", " << std::thread::hardware_concurrency() << " cores\n";
+
+		std::vector<size_t> worker_counts = {1, 2, 4};
+
+		if (std::thread::hardware_concurrency() > 4) {
+			worker_counts.push_back (std::thread::hardware_concurrency());
+		}
+
+		std::vector<std::vector<ns_read::rss_article>> feed_lines_baseline;
+
+		for (const size_t worker_count : worker_counts) {
+			std::vector<std::vector<ns_read::rss_article>> feed_lines;
+
+			const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+			for (int repeat = 0; repeat < repeat_count; repeat++) {
+				feed_lines.clear();
+
+				ns_parse::parse_many_feeds (feed_data, feed_lines, ns_parse::feed_parse_mode::stream, worker_count);
+			}
+
+			const int64_t microseconds = std::chrono::duration_cast<std::chrono::microseconds>
+			                             (std::chrono::steady_clock::now() - start_time).count();
+
+			std::cout << "\t" << worker_count << " threads:\t" << microseconds / repeat_count << " us per batch\n";
+
+			if (worker_count == 1) {
+				feed_lines_baseline = std::move (feed_lines);
+
+				continue;
+			}
+
+			bool is_same = (feed_lines.size() == feed_lines_baseline.size());
+
+			for (size_t i = 0; is_same && i < feed_lines.size(); i++) {
+				is_same = (feed_lines[i].size() == feed_lines_baseline[i].size());
+
+				for (size_t j = 0; is_same && j < feed_lines[i].size(); j++) {
+					const ns_read::rss_article& article1 = feed_lines_baseline[i][j];
+					const ns_read::rss_article& article2 = feed_lines[i][j];
+
+					is_same = (article1.headline == article2.headline && article1.url == article2.url &&
+					           article1.article_date == article2.article_date &&
+					           article1.article_summary == article2.article_summary &&
+					           article1.article_text == article2.article_text);
+				}
+			}
+
+			if (is_same == false) {
+				std::cout << "ERROR: results differ with " << worker_count << " threads\n";
+			}
+		}
+
+		return;
+	}
+
 	int
 	cleanup_argtable (void** argtable, int exit_code)
 	{
@@ -130,6 +874,11 @@ main (int argc, char** argv)
 	struct arg_lit* cli_op_file_in_and_out;	//1
 	struct arg_lit* cli_op_rss_download;	//2
 	struct arg_lit* cli_op_flat_rss;	//3
+	struct arg_lit* cli_op_bench_date_time;	//4
+	struct arg_lit* cli_op_bench_text;	//5
+	struct arg_lit* cli_op_bench_parse;	//6
+	struct arg_lit* cli_op_bench_download;	//7
+	struct arg_lit* cli_op_bench_parse_many;	//8
 
 	struct arg_str* cli_rss_feed_name;	//RSS Feed Name
 	struct arg_str* cli_rss_feed_url;	//RSS Feed URL
@@ -159,6 +908,11 @@ main (int argc, char** argv)
 		cli_op_file_in_and_out  = arg_litn /*1*/ (nullptr, "fifo", 0, 1, "Duplicate a file to test basic file I/O"),
 		cli_op_rss_download   	= arg_litn /*2*/ (nullptr, "get-rss", 0, 1, "Download rss feed to an offline rss xml file"),
 		cli_op_flat_rss    	= arg_litn /*3*/ (nullptr, "flat-rss-file", 0, 1, "Convert an RSS XML file to flat data file"),
+		cli_op_bench_date_time	= arg_litn /*4*/ (nullptr, "bench-datetime", 0, 1, "Time the feed freshness check for 10000 feeds"),
+		cli_op_bench_text	= arg_litn /*5*/ (nullptr, "bench-text", 0, 1, "Time the text kernels against char at a time code"),
+		cli_op_bench_parse	= arg_litn /*6*/ (nullptr, "bench-parse", 0, 1, "Time document and stream parsing of a large feed and a deeply nested feed"),
+		cli_op_bench_download	= arg_litn /*7*/ (nullptr, "bench-download", 0, 1, "Time download then parse against parse during download of rss-url"),
+		cli_op_bench_parse_many	= arg_litn /*8*/ (nullptr, "bench-parse-many", 0, 1, "Time parsing 500 feeds on 1 thread and on more threads"),
 
 		/*Additional options*/
 		cli_rss_feed_name	= arg_strn (nullptr, "rss-feedname", "<string>", 0, 1, "Name of the RSS Feed"),
@@ -337,6 +1091,53 @@ main (int argc, char** argv)
 		}
 	}
 
+	/*
+		4)	Date/time benchmark
+	*/
+
+	else if (cli_op_bench_date_time->count > 0) {
+		benchmark_date_time (10000);
+	}
+
+	/*
+		5)	Text kernel benchmark
+	*/
+
+	else if (cli_op_bench_text->count > 0) {
+		benchmark_text_kernels (10000, 50);
+	}
+
+	/*
+		6)	Feed parse benchmark
+	*/
+
+	else if (cli_op_bench_parse->count > 0) {
+		benchmark_feed_parse (20000, 0, 5);
+		benchmark_feed_parse (2000, 200, 5);
+	}
+
+	/*
+		7)	Feed download benchmark
+	*/
+
+	else if (cli_op_bench_download->count > 0) {
+		if (feed_url.empty()) {
+			std::cout << "ERROR: Need value --rss-url=\"value\" for --bench-download\n";
+
+			return cleanup_argtable (argtable, exit_code);
+		}
+
+		benchmark_feed_download (feed_url, 5);
+	}
+
+	/*
+		8)	Parallel feed parse benchmark
+	*/
+
+	else if (cli_op_bench_parse_many->count > 0) {
+		benchmark_parse_many_feeds (500, 100, 3);
+	}
+
 	/*
 		***	else-error	****
 
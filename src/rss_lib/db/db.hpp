@@ -13,7 +13,11 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #ifndef michael_gautier_rss_database_api_h
 #define michael_gautier_rss_database_api_h
 
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -24,6 +28,82 @@ namespace gautier_rss_database {
 	using sql_rowset_type = std::vector<sql_row_type>;
 	using sql_parameter_list_type = std::vector<std::string>;
 
+	/*
+		A write run by the write queue thread on the writer connection.
+		Returns true when every statement of the write succeeded.
+	*/
+	using sql_write_operation_type = std::function<bool (sqlite3** db)>;
+
+	struct sql_statement_cache_stats
+	{
+		public:
+			int64_t hits = 0;
+			int64_t misses = 0;
+			int64_t statement_count = 0;
+	};
+
+	/*
+		SQL CURSOR
+
+		Streams rows from a statement one at a time.
+
+		Column values are read by position straight from SQLite.
+		Text returned by get_column_text points into SQLite memory and
+		is only valid until the next call to next_row or close_cursor.
+		Copy the value if it must outlive the current row.
+	*/
+	struct sql_cursor
+	{
+		public:
+			sqlite3* db = nullptr;
+			sqlite3_stmt* statement = nullptr;
+			std::string sql_text;
+			bool cached = false;
+			int step_result = SQLITE_DONE;
+			int64_t row_count = 0;
+			int64_t step_nanoseconds = 0;
+	};
+
+	/*
+		STATEMENT PROFILE
+
+		Totals for one SQL text across every connection since profiling was enabled.
+		rows_stepped counts rows read through a cursor. full_scan_steps, sort_count and
+		vm_steps come from sqlite3_stmt_status.
+	*/
+	struct sql_statement_profile
+	{
+		public:
+			std::string sql_text;
+			int64_t call_count = 0;
+			int64_t total_nanoseconds = 0;
+			int64_t p50_nanoseconds = 0;
+			int64_t p95_nanoseconds = 0;
+			int64_t p99_nanoseconds = 0;
+			int64_t max_nanoseconds = 0;
+			int64_t rows_stepped = 0;
+			int64_t full_scan_steps = 0;
+			int64_t sort_count = 0;
+			int64_t vm_steps = 0;
+	};
+
+	using sql_statement_profile_list_type = std::vector<sql_statement_profile>;
+
+	/*
+		SCHEMA MIGRATION
+
+		A migration moves the database schema to a version number.
+		The version is stored in the file with PRAGMA user_version.
+	*/
+	struct sql_migration
+	{
+		public:
+			int64_t version = 0;
+			std::vector<std::string> sql_texts;
+	};
+
+	using sql_migration_list_type = std::vector<sql_migration>;
+
 	extern "C" {
 		int create_sql_row (void* generic_object, const int col_count, char** col_values, char** col_names);
 	}
@@ -31,6 +111,42 @@ namespace gautier_rss_database {
 	bool
 	open_db (const std::string db_file_name, sqlite3** db);
 
+	/*
+		DATABASE SESSION
+
+		Keeps connections open to a database file across many calls.
+
+		Sessions are reference counted by file name. The first open_session
+		opens the file (in WAL mode) and the connections are closed when the last
+		holder calls close_session. Hold a session for the life of a program
+		(or a refresh cycle) so individual reads and writes do not pay the cost
+		of opening the file.
+
+		Writes go through acquire_writer/release_writer. There is one writer
+		connection per session and it is used by one thread at a time. The same
+		thread may acquire it again while already holding it.
+
+		Reads go through acquire_reader/release_reader. Each caller gets its own
+		read connection from a pool so reads never wait on a write in progress.
+	*/
+	bool
+	open_session (const std::string db_file_name);
+
+	void
+	close_session (const std::string db_file_name);
+
+	sqlite3*
+	acquire_writer (const std::string db_file_name);
+
+	void
+	release_writer (const std::string db_file_name);
+
+	sqlite3*
+	acquire_reader (const std::string db_file_name);
+
+	void
+	release_reader (const std::string db_file_name, sqlite3* db);
+
 	void
 	process_sql_simple (sqlite3** db, const std::string sql_text, sql_rowset_type& rows);
 
@@ -40,12 +156,152 @@ namespace gautier_rss_database {
 	void
 	close_db (sqlite3** db);
 
-	void
+	/*
+		True when the statement ran to completion.
+	*/
+	bool
 	process_sql (sqlite3** db, const std::string sql_text, sql_parameter_list_type sql_param_values,
 	             sql_rowset_type& rows);
 
-	void
+	bool
 	process_sql (sqlite3** db, const std::string sql_text, sql_parameter_list_type sql_param_values);
 
+	/*
+		Prepares (or reuses) a statement and binds the parameters.
+		Call next_row until it returns false and then call close_cursor.
+	*/
+	bool
+	open_cursor (sqlite3** db, const std::string sql_text, const sql_parameter_list_type& sql_param_values,
+	             sql_cursor& cursor);
+
+	bool
+	next_row (sql_cursor& cursor);
+
+	int
+	get_column_count (sql_cursor& cursor);
+
+	std::string_view
+	get_column_text (sql_cursor& cursor, const int col_index);
+
+	int64_t
+	get_column_int64 (sql_cursor& cursor, const int col_index);
+
+	bool
+	is_column_null (sql_cursor& cursor, const int col_index);
+
+	/*
+		For a BLOB column get_column_text returns the bytes unchanged.
+		Call is_column_blob before get_column_text on the same column.
+	*/
+	bool
+	is_column_blob (sql_cursor& cursor, const int col_index);
+
+	void
+	close_cursor (sql_cursor& cursor);
+
+	/*
+		TRANSACTIONS
+
+		begin_transaction starts a write transaction unless the connection is
+		already inside one. It returns true only when this call started it.
+		Pass that value to commit_transaction/rollback_transaction so that only
+		the outermost caller ends the transaction.
+	*/
+	bool
+	begin_transaction (sqlite3** db);
+
+	bool
+	commit_transaction (sqlite3** db, const bool transaction_started);
+
+	void
+	rollback_transaction (sqlite3** db, const bool transaction_started);
+
+	/*
+		WRITE QUEUE
+
+		A thread that runs writes for one database file in the background.
+		Callers queue a write and continue without waiting on the disk.
+
+		Writes queued close together share one transaction (group commit). A
+		transaction begins at most max_commit_delay_in_milliseconds after the oldest
+		write in it was queued, or sooner once max_batch_size writes are waiting.
+		Writes run in the order queued.
+
+		Each write runs inside a savepoint. A write that returns false is rolled back
+		alone and the other writes of the transaction still commit. When the transaction
+		cannot begin, no write of the batch runs.
+
+		The future returned by queue_write becomes ready after the transaction
+		that holds the write ends. Its value is true when the write succeeded and
+		the transaction committed.
+
+		Without a running queue, queue_write runs the write in its own transaction
+		on the calling thread and returns a future that is already ready.
+
+		stop_write_queue runs every write still queued and then ends the thread.
+	*/
+	void
+	start_write_queue (const std::string db_file_name, const int64_t max_commit_delay_in_milliseconds,
+	                   const size_t max_batch_size);
+
+	std::future<bool>
+	queue_write (const std::string db_file_name, sql_write_operation_type operation);
+
+	void
+	stop_write_queue (const std::string db_file_name);
+
+	/*
+		STATEMENT PROFILING
+
+		Off by default. Enable it before the database is opened (before initialize_db):
+		only connections opened while profiling is enabled report their statements.
+
+		get_statement_profiles returns the statements ordered by total time, highest first.
+		print_statement_profiles writes the same list to standard output as a table.
+	*/
+	void
+	set_statement_profiling (const bool enabled);
+
+	bool
+	is_statement_profiling_enabled();
+
+	sql_statement_profile_list_type
+	get_statement_profiles();
+
+	void
+	reset_statement_profiles();
+
+	void
+	print_statement_profiles();
+
+	int64_t
+	get_schema_version (sqlite3** db);
+
+	/*
+		Rows changed by the most recent INSERT, UPDATE or DELETE on the connection.
+	*/
+	int64_t
+	get_changed_row_count (sqlite3** db);
+
+	/*
+		Applies, in order, each migration newer than the stored schema version.
+		Each migration runs in its own transaction together with the version update.
+		Stops at the first failed migration and leaves the schema at the last good version.
+
+		Foreign key enforcement is off while migrations run so tables can be rebuilt.
+		A migration that leaves a dangling reference is rolled back.
+	*/
+	bool
+	migrate_schema (sqlite3** db, const sql_migration_list_type& migrations);
+
+	/*
+		Prepared statements used by process_sql are cached per connection.
+		A hit reuses a statement already compiled for the same SQL text.
+
+		Totals cover the connections currently open in the session.
+	*/
+	sql_statement_cache_stats
+	get_statement_cache_stats (const std::string db_file_name);
+
 }
 #endif
@@ -10,162 +10,1438 @@ You should have received a copy of the GNU Lesser General Public License along w
 Author: Michael Gautier <michaelgautier.wordpress.com>
 */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 
 #include "rss_lib/db/db.hpp"
 
+namespace {
+	/*
+		DATABASE SESSION
+
+		The database runs in WAL mode. That allows readers to continue while a write is in progress.
+
+		Each session has one writer connection. Writes from every thread go through it
+		one caller at a time. Read connections come from a small pool so the UI
+		and the download thread can read at the same time without waiting on each other.
+	*/
+	struct db_session
+	{
+		public:
+			sqlite3* writer = nullptr;
+			std::recursive_mutex writer_lock;
+
+			std::vector<sqlite3*> idle_readers;
+
+			int_fast32_t hold_count = 0;
+	};
+
+	std::map<std::string, db_session>
+	db_sessions;
+
+	std::mutex
+	db_sessions_lock;
+
+	/*Read connections kept open for reuse. Any beyond this are closed on release.*/
+	const size_t
+	reader_pool_max = 4;
+
+	/*How long a connection waits on a lock held by another connection or process.*/
+	const int
+	busy_timeout_in_milliseconds = 8000;
+
+	db_session*
+	hold_session (const std::string& db_file_name);
+
+	void
+	drop_session (const std::string& db_file_name);
+
+	sqlite3*
+	open_reader (const std::string& db_file_name);
+
+	/*
+		PREPARED STATEMENT CACHE
+
+		Statements are kept per connection and keyed by SQL text.
+		A cached statement is checked out by one caller at a time. If another
+		thread on the same connection asks for the same SQL while it is checked out,
+		that caller gets a one-time statement that is finalized after use.
+	*/
+	struct sql_cached_statement
+	{
+		public:
+			sqlite3_stmt* statement = nullptr;
+			bool in_use = false;
+	};
+
+	struct sql_statement_cache
+	{
+		public:
+			std::unordered_map<std::string, sql_cached_statement> statements;
+
+			int64_t hits = 0;
+			int64_t misses = 0;
+	};
+
+	std::map<sqlite3*, sql_statement_cache>
+	statement_caches;
+
+	std::mutex
+	statement_caches_lock;
+
+	/*Upper bound on distinct SQL texts cached per connection.*/
+	const size_t
+	statement_cache_max = 64;
+
+	sqlite3_stmt*
+	acquire_statement (sqlite3* db, const std::string& sql_text, bool& cached);
+
+	void
+	release_statement (sqlite3* db, const std::string& sql_text, sqlite3_stmt* statement, const bool cached);
+
+	void
+	clear_statement_cache (sqlite3* db);
+
+	bool
+	execute_sql (sqlite3* db, const std::string& sql_text);
+
+	bool
+	has_valid_foreign_keys (sqlite3* db);
+
+	/*
+		WRITE QUEUE
+
+		One thread per database file takes writes off the queue in batches.
+		Each batch runs in a single transaction on the session writer.
+	*/
+	struct sql_queued_write
+	{
+		public:
+			gautier_rss_database::sql_write_operation_type operation;
+			std::promise<bool> committed;
+			bool succeeded = false;
+			std::chrono::steady_clock::time_point queued_time;
+	};
+
+	struct sql_write_queue
+	{
+		public:
+			std::string db_file_name;
+			std::chrono::milliseconds max_commit_delay {0};
+			size_t max_batch_size = 1;
+
+			std::deque<sql_queued_write> writes;
+			bool stopping = false;
+
+			std::mutex lock;
+			std::condition_variable signal;
+			std::thread thread;
+	};
+
+	std::map<std::string, std::unique_ptr<sql_write_queue>>
+	write_queues;
+
+	std::mutex
+	write_queues_lock;
+
+	void
+	run_write_queue (sql_write_queue* queue);
+
+	bool
+	run_write_operation (sqlite3** db, const gautier_rss_database::sql_write_operation_type& operation);
+
+	bool
+	is_in_transaction (sqlite3* db);
+
+	/*
+		STATEMENT PROFILING
+
+		Statements run through a cursor are timed around sqlite3_step with a steady clock.
+		Everything else (sqlite3_exec, statements run by triggers and FTS5) is reported by
+		sqlite3_trace_v2, which SQLite times to the millisecond only. The time of a statement
+		includes the time of the statements it triggers.
+
+		Results accumulate per SQL text. Latency is kept as a histogram so percentiles
+		cost a fixed amount of memory no matter how often a statement runs.
+
+		Each power of 2 nanoseconds is split into 4 buckets. A percentile is reported
+		as the upper limit of its bucket, at most 25% above the true value.
+	*/
+	const size_t
+	latency_bucket_count = 256;
+
+	struct sql_statement_profile_data
+	{
+		public:
+			int64_t call_count = 0;
+			int64_t total_nanoseconds = 0;
+			int64_t max_nanoseconds = 0;
+			int64_t rows_stepped = 0;
+			int64_t full_scan_steps = 0;
+			int64_t sort_count = 0;
+			int64_t vm_steps = 0;
+
+			std::array<int64_t, latency_bucket_count> latency_buckets {};
+	};
+
+	std::atomic_bool
+	statement_profiling_enabled = false;
+
+	std::unordered_map<std::string, sql_statement_profile_data>
+	statement_profiles;
+
+	std::mutex
+	statement_profiles_lock;
+
+	/*The cursor statement being stepped or reset on this thread. Timed by the cursor, not the trace.*/
+	thread_local sqlite3_stmt*
+	timed_cursor_statement = nullptr;
+
+	size_t
+	get_latency_bucket (const int64_t nanoseconds);
+
+	int64_t
+	get_latency_bucket_limit (const size_t bucket);
+
+	int64_t
+	get_latency_percentile (const sql_statement_profile_data& profile, const int64_t percent);
+
+	void
+	add_statement_profile (const std::string& sql_text, sqlite3_stmt* statement, const int64_t nanoseconds,
+	                       const int64_t row_count);
+
+	int
+	trace_statement (unsigned trace_type, void* context, void* statement_ptr, void* nanoseconds_ptr);
+
+	sqlite3_stmt*
+	acquire_statement (sqlite3* db, const std::string& sql_text, bool& cached)
+	{
+		cached = false;
+
+		if (db == nullptr) {
+			return nullptr;
+		}
+
+		bool cache_full = false;
+		{
+			std::lock_guard<std::mutex> cache_guard (statement_caches_lock);
+
+			sql_statement_cache* cache = &statement_caches[db];
+
+			auto match = cache->statements.find (sql_text);
+
+			if (match != cache->statements.end() && match->second.in_use == false) {
+				match->second.in_use = true;
+
+				cache->hits++;
+
+				cached = true;
+
+				return match->second.statement;
+			}
+
+			cache->misses++;
+
+			cache_full = (match != cache->statements.end() || cache->statements.size() >= statement_cache_max);
+		}
+
+		sqlite3_stmt* statement = nullptr;
+
+		const int prepare_result = sqlite3_prepare_v3 (db, sql_text.data(), -1, SQLITE_PREPARE_PERSISTENT, &statement,
+		                           nullptr);
+
+		if (prepare_result != SQLITE_OK) {
+			std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") SQL Prepare Result: " << prepare_result
+			          << "\n\n";
+		}
+
+		if (statement && cache_full == false) {
+			std::lock_guard<std::mutex> cache_guard (statement_caches_lock);
+
+			sql_statement_cache* cache = &statement_caches[db];
+
+			auto [match, inserted] = cache->statements.try_emplace (sql_text, sql_cached_statement());
+
+			if (inserted) {
+				match->second.statement = statement;
+				match->second.in_use = true;
+
+				cached = true;
+			}
+		}
+
+		return statement;
+	}
+
+	void
+	release_statement (sqlite3* db, const std::string& sql_text, sqlite3_stmt* statement, const bool cached)
+	{
+		if (cached) {
+			sqlite3_reset (statement);
+			sqlite3_clear_bindings (statement);
+
+			std::lock_guard<std::mutex> cache_guard (statement_caches_lock);
+
+			statement_caches[db].statements[sql_text].in_use = false;
+		} else {
+			sqlite3_finalize (statement);
+		}
+
+		return;
+	}
+
+	void
+	clear_statement_cache (sqlite3* db)
+	{
+		std::lock_guard<std::mutex> cache_guard (statement_caches_lock);
+
+		const size_t cache_count = statement_caches.count (db);
+
+		if (cache_count > 0) {
+			for (auto& [sql_text, cached_statement] : statement_caches[db].statements) {
+				sqlite3_finalize (cached_statement.statement);
+			}
+
+			statement_caches.erase (db);
+		}
+
+		return;
+	}
+
+	bool
+	execute_sql (sqlite3* db, const std::string& sql_text)
+	{
+		char* error_message = nullptr;
+
+		const int exec_result = sqlite3_exec (db, sql_text.data(), nullptr, nullptr, &error_message);
+
+		if (error_message) {
+			std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") SQL Result: " << error_message <<
+			          "\n\n";
+
+			sqlite3_free (error_message);
+		}
+
+		return (exec_result == SQLITE_OK);
+	}
+
+	/*
+		True when PRAGMA foreign_key_check reports no rows that reference a missing parent row.
+	*/
+	bool
+	has_valid_foreign_keys (sqlite3* db)
+	{
+		bool is_valid = false;
+
+		sqlite3_stmt* statement = nullptr;
+
+		if (sqlite3_prepare_v2 (db, "PRAGMA foreign_key_check;", -1, &statement, nullptr) == SQLITE_OK) {
+			const int step_result = sqlite3_step (statement);
+
+			is_valid = (step_result == SQLITE_DONE);
+
+			if (step_result == SQLITE_ROW) {
+				std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") Foreign key violation in table " <<
+				          sqlite3_column_text (statement, 0) << "\n\n";
+			}
+		}
+
+		sqlite3_finalize (statement);
+
+		return is_valid;
+	}
+
+	/*
+		Call with db_sessions_lock held.
+
+		Creates the session on first use and opens the writer connection in WAL mode.
+	*/
+	db_session*
+	hold_session (const std::string& db_file_name)
+	{
+		db_session* session = &db_sessions[db_file_name];
+
+		if (session->writer == nullptr) {
+			const bool opened = gautier_rss_database::open_db (db_file_name, &session->writer);
+
+			if (opened == false) {
+				gautier_rss_database::close_db (&session->writer);
+
+				db_sessions.erase (db_file_name);
+
+				return nullptr;
+			}
+
+			/*
+				Free pages are returned to the file system a few at a time by
+				incremental_vacuum instead of rewriting the file with VACUUM.
+				Only takes effect on a new database or at the next VACUUM.
+			*/
+			execute_sql (session->writer, "PRAGMA auto_vacuum = INCREMENTAL;");
+
+			/*
+				WAL lets readers see the last committed data while the writer works.
+				NORMAL sync is durable across application crashes in WAL mode.
+			*/
+			execute_sql (session->writer, "PRAGMA journal_mode = WAL;");
+			execute_sql (session->writer, "PRAGMA synchronous = NORMAL;");
+
+			/*
+				Foreign key actions (ON DELETE CASCADE) only run when enabled per connection.
+			*/
+			execute_sql (session->writer, "PRAGMA foreign_keys = ON;");
+
+			/*
+				Bounds the rows ANALYZE reads per index when PRAGMA optimize runs.
+			*/
+			execute_sql (session->writer, "PRAGMA analysis_limit = 400;");
+		}
+
+		session->hold_count++;
+
+		return session;
+	}
+
+	/*
+		Call with db_sessions_lock held.
+
+		Closes every connection when the last hold is released.
+	*/
+	void
+	drop_session (const std::string& db_file_name)
+	{
+		const size_t session_count = db_sessions.count (db_file_name);
+
+		if (session_count > 0) {
+			db_session* session = &db_sessions[db_file_name];
+
+			session->hold_count--;
+
+			if (session->hold_count < 1) {
+				for (sqlite3* reader : session->idle_readers) {
+					gautier_rss_database::close_db (&reader);
+				}
+
+				gautier_rss_database::close_db (&session->writer);
+
+				db_sessions.erase (db_file_name);
+			}
+		}
+
+		return;
+	}
+
+	sqlite3*
+	open_reader (const std::string& db_file_name)
+	{
+		sqlite3* reader = nullptr;
+
+		const bool opened = gautier_rss_database::open_db (db_file_name, &reader);
+
+		if (opened) {
+			execute_sql (reader, "PRAGMA query_only = ON;");
+		} else {
+			gautier_rss_database::close_db (&reader);
+
+			reader = nullptr;
+		}
+
+		return reader;
+	}
+
+	void
+	run_write_queue (sql_write_queue* queue)
+	{
+		std::vector<sql_queued_write> batch;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> queue_guard (queue->lock);
+
+				queue->signal.wait (queue_guard, [queue]() {
+					return (queue->stopping || queue->writes.empty() == false);
+				});
+
+				if (queue->writes.empty()) {
+					break;
+				}
+
+				/*
+					Give other writes a chance to join the transaction, up to the latency bound
+					of the oldest write.
+				*/
+				const std::chrono::steady_clock::time_point commit_time = queue->writes.front().queued_time +
+				        queue->max_commit_delay;
+
+				queue->signal.wait_until (queue_guard, commit_time, [queue]() {
+					return (queue->stopping || queue->writes.size() >= queue->max_batch_size);
+				});
+
+				const size_t batch_size = std::min (queue->writes.size(), queue->max_batch_size);
+
+				for (size_t i = 0; i < batch_size; i++) {
+					batch.push_back (std::move (queue->writes.front()));
+
+					queue->writes.pop_front();
+				}
+			}
+
+			sqlite3* db = gautier_rss_database::acquire_writer (queue->db_file_name);
+
+			bool committed = false;
+
+			if (db) {
+				const bool transaction_started = gautier_rss_database::begin_transaction (&db);
+
+				/*
+					An error such as a full disk can end the whole transaction. The writes
+					after it are not run, since they would commit one statement at a time.
+				*/
+				if (transaction_started) {
+					for (sql_queued_write& write : batch) {
+						if (is_in_transaction (db)) {
+							write.succeeded = run_write_operation (&db, write.operation);
+						}
+					}
+
+					if (is_in_transaction (db)) {
+						committed = gautier_rss_database::commit_transaction (&db, transaction_started);
+					}
+				}
+
+				gautier_rss_database::release_writer (queue->db_file_name);
+			}
+
+			for (sql_queued_write& write : batch) {
+				write.committed.set_value (committed && write.succeeded);
+			}
+
+			batch.clear();
+		}
+
+		return;
+	}
+
+	/*
+		Runs one write inside a savepoint. A write that fails is rolled back alone,
+		without the writes before it in the same transaction.
+	*/
+	bool
+	run_write_operation (sqlite3** db, const gautier_rss_database::sql_write_operation_type& operation)
+	{
+		bool success = execute_sql (*db, "SAVEPOINT queued_write;");
+
+		if (success) {
+			success = operation (db);
+
+			if (success == false) {
+				execute_sql (*db, "ROLLBACK TO queued_write;");
+			}
+
+			success = execute_sql (*db, "RELEASE queued_write;") && success;
+		}
+
+		return success;
+	}
+
+	bool
+	is_in_transaction (sqlite3* db)
+	{
+		return (sqlite3_get_autocommit (db) == 0);
+	}
+
+	size_t
+	get_latency_bucket (const int64_t nanoseconds)
+	{
+		if (nanoseconds < 4) {
+			return (size_t) (std::max<int64_t> (nanoseconds, 0));
+		}
+
+		const uint64_t value = (uint64_t)nanoseconds;
+
+		const int high_bit = 63 - __builtin_clzll (value);
+
+		/*The 2 bits below the highest set bit select the quarter of the octave.*/
+		const size_t quarter = (size_t) ((value >> (high_bit - 2)) & 3);
+
+		const size_t bucket = ((size_t)high_bit * 4) + quarter;
+
+		return std::min (bucket, latency_bucket_count - 1);
+	}
+
+	int64_t
+	get_latency_bucket_limit (const size_t bucket)
+	{
+		if (bucket < 4) {
+			return (int64_t)bucket;
+		}
+
+		const size_t high_bit = bucket / 4;
+		const uint64_t quarter = (uint64_t) (bucket % 4);
+
+		return (int64_t) (((4 + quarter + 1) << (high_bit - 2)) - 1);
+	}
+
+	int64_t
+	get_latency_percentile (const sql_statement_profile_data& profile, const int64_t percent)
+	{
+		const int64_t rank = std::max<int64_t> (1, (profile.call_count * percent + 99) / 100);
+
+		int64_t count = 0;
+
+		for (size_t bucket = 0; bucket < latency_bucket_count; bucket++) {
+			count += profile.latency_buckets[bucket];
+
+			if (count >= rank) {
+				return std::min (get_latency_bucket_limit (bucket), profile.max_nanoseconds);
+			}
+		}
+
+		return profile.max_nanoseconds;
+	}
+
+	/*
+		Records one run of a statement.
+		The statement counters are read and reset so the next run starts from zero.
+	*/
+	void
+	add_statement_profile (const std::string& sql_text, sqlite3_stmt* statement, const int64_t nanoseconds,
+	                       const int64_t row_count)
+	{
+		const int full_scan_steps = sqlite3_stmt_status (statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+		const int sort_count = sqlite3_stmt_status (statement, SQLITE_STMTSTATUS_SORT, 1);
+		const int vm_steps = sqlite3_stmt_status (statement, SQLITE_STMTSTATUS_VM_STEP, 1);
+
+		std::lock_guard<std::mutex> profiles_guard (statement_profiles_lock);
+
+		sql_statement_profile_data* profile = &statement_profiles[sql_text];
+
+		profile->call_count++;
+		profile->total_nanoseconds += nanoseconds;
+		profile->max_nanoseconds = std::max (profile->max_nanoseconds, nanoseconds);
+		profile->rows_stepped += row_count;
+		profile->full_scan_steps += full_scan_steps;
+		profile->sort_count += sort_count;
+		profile->vm_steps += vm_steps;
+		profile->latency_buckets[get_latency_bucket (nanoseconds)]++;
+
+		return;
+	}
+
+	/*
+		Called by SQLite each time a statement finishes running.
+	*/
+	int
+	trace_statement (unsigned trace_type, void* context, void* statement_ptr, void* nanoseconds_ptr)
+	{
+		if (context || trace_type != SQLITE_TRACE_PROFILE || statement_profiling_enabled == false) {
+			return 0;
+		}
+
+		sqlite3_stmt* statement = (sqlite3_stmt*)statement_ptr;
+
+		if (statement == timed_cursor_statement) {
+			return 0;
+		}
+
+		const char* sql_text = sqlite3_sql (statement);
+
+		if (sql_text) {
+			const int64_t nanoseconds = (int64_t) (* (sqlite3_int64*)nanoseconds_ptr);
+
+			add_statement_profile (sql_text, statement, nanoseconds, 0);
+		}
+
+		return 0;
+	}
+}
+
+bool
+gautier_rss_database::open_db (const std::string db_file_name, sqlite3** db)
+{
+	bool success = false;
+
+	const int options = (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX);
+
+	const int open_result = sqlite3_open_v2 (db_file_name.data(), db, options, nullptr);
+
+	sqlite3_extended_result_codes (*db, 1);
+
+	sqlite3_busy_timeout (*db, busy_timeout_in_milliseconds);
+
+	if (statement_profiling_enabled) {
+		sqlite3_trace_v2 (*db, SQLITE_TRACE_PROFILE, trace_statement, nullptr);
+	}
+
+	if (open_result == SQLITE_OK) {
+		success = true;
+	} else {
+		std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") Db Open Result: " << open_result <<
+		          "\n\n";
+	}
+
+	return success;
+}
+
+bool
+gautier_rss_database::open_session (const std::string db_file_name)
+{
+	std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+	db_session* session = hold_session (db_file_name);
+
+	return (session != nullptr);
+}
+
+void
+gautier_rss_database::close_session (const std::string db_file_name)
+{
+	std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+	drop_session (db_file_name);
+
+	return;
+}
+
+sqlite3*
+gautier_rss_database::acquire_writer (const std::string db_file_name)
+{
+	sqlite3* db = nullptr;
+
+	std::recursive_mutex* writer_lock = nullptr;
+	{
+		std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+		db_session* session = hold_session (db_file_name);
+
+		if (session) {
+			db = session->writer;
+			writer_lock = &session->writer_lock;
+		}
+	}
+
+	/*
+		Wait outside the sessions lock so other sessions and readers are not blocked.
+		The hold taken above keeps the session alive while waiting.
+	*/
+	if (writer_lock) {
+		writer_lock->lock();
+	}
+
+	return db;
+}
+
+void
+gautier_rss_database::release_writer (const std::string db_file_name)
+{
+	std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+	const size_t session_count = db_sessions.count (db_file_name);
+
+	if (session_count > 0) {
+		db_session* session = &db_sessions[db_file_name];
+
+		session->writer_lock.unlock();
+
+		drop_session (db_file_name);
+	}
+
+	return;
+}
+
+sqlite3*
+gautier_rss_database::acquire_reader (const std::string db_file_name)
+{
+	sqlite3* db = nullptr;
+
+	std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+	db_session* session = hold_session (db_file_name);
+
+	if (session) {
+		if (session->idle_readers.empty() == false) {
+			db = session->idle_readers.back();
+
+			session->idle_readers.pop_back();
+		} else {
+			db = open_reader (db_file_name);
+		}
+
+		if (db == nullptr) {
+			drop_session (db_file_name);
+		}
+	}
+
+	return db;
+}
+
+void
+gautier_rss_database::release_reader (const std::string db_file_name, sqlite3* db)
+{
+	std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+	const size_t session_count = db_sessions.count (db_file_name);
+
+	if (session_count > 0 && db) {
+		db_session* session = &db_sessions[db_file_name];
+
+		if (session->idle_readers.size() < reader_pool_max) {
+			session->idle_readers.push_back (db);
+		} else {
+			close_db (&db);
+		}
+
+		drop_session (db_file_name);
+	}
+
+	return;
+}
+
+void
+gautier_rss_database::close_db (sqlite3** db)
+{
+	if (db) {
+		clear_statement_cache (*db);
+
+		sqlite3_close_v2 (*db);
+	}
+
+	return;
+}
+
+int
+gautier_rss_database::create_sql_row (void* generic_object, const int col_count, char** col_values,
+                                      char** col_names)
+{
+	sql_rowset_type* rows = (sql_rowset_type*)generic_object;
+
+	rows->emplace_back (sql_row_type());
+
+	sql_row_type* row = & (rows->back());
+
+	for (int i = 0; i < col_count; i++) {
+		const std::string name = col_names[i];
+		const std::string value = (col_values[i] ? col_values[i] : "");
+
+		row->insert_or_assign (name, value);
+	}
+
+	return 0;
+}
+
+void
+gautier_rss_database::process_sql_simple (sqlite3** db, const std::string sql_text, sql_rowset_type& rows)
+{
+	sql_rowset_type* tmp_rows = &rows;
+
+	char* error_message;
+
+	sqlite3_exec (*db, sql_text.data(), create_sql_row, (void*)tmp_rows, &error_message);
+
+	return;
+}
+
+void
+gautier_rss_database::process_sql_simple (sqlite3** db, const std::string sql_text)
+{
+	char* error_message;
+
+	sqlite3_exec (*db, sql_text.data(), nullptr, nullptr, &error_message);
+
+	if (error_message) {
+		std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") SQL Result: " << error_message <<
+		          "\n\n";
+	}
+
+	return;
+}
+
+bool
+gautier_rss_database::open_cursor (sqlite3** db, const std::string sql_text,
+                                   const sql_parameter_list_type& sql_param_values, sql_cursor& cursor)
+{
+	cursor.db = *db;
+	cursor.sql_text = sql_text;
+	cursor.cached = false;
+	cursor.step_result = SQLITE_DONE;
+	cursor.row_count = 0;
+	cursor.step_nanoseconds = 0;
+	cursor.statement = acquire_statement (cursor.db, cursor.sql_text, cursor.cached);
+
+	if (cursor.statement == nullptr) {
+		return false;
+	}
+
+	int i = 0;
+
+	for (const sql_parameter_list_type::value_type& sql_parameter : sql_param_values) {
+		i++;
+		sqlite3_bind_text (cursor.statement, i, sql_parameter.data(), (int) (sql_parameter.size()), SQLITE_TRANSIENT);
+	}
+
+	return true;
+}
+
 bool
-gautier_rss_database::open_db (const std::string db_file_name, sqlite3** db)
+gautier_rss_database::next_row (sql_cursor& cursor)
 {
-	bool success = false;
+	if (cursor.statement == nullptr) {
+		return false;
+	}
 
-	const int options = (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX);
+	if (statement_profiling_enabled) {
+		const std::chrono::steady_clock::time_point step_start = std::chrono::steady_clock::now();
 
-	const int open_result = sqlite3_open_v2 (db_file_name.data(), db, options, nullptr);
+		timed_cursor_statement = cursor.statement;
 
-	sqlite3_extended_result_codes (*db, 1);
+		cursor.step_result = sqlite3_step (cursor.statement);
 
-	if (open_result == SQLITE_OK) {
-		success = true;
+		timed_cursor_statement = nullptr;
+
+		cursor.step_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>
+		                           (std::chrono::steady_clock::now() - step_start).count();
 	} else {
-		std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") Db Open Result: " << open_result <<
-		          "\n\n";
+		cursor.step_result = sqlite3_step (cursor.statement);
 	}
 
-	return success;
+	if (cursor.step_result == SQLITE_ROW) {
+		cursor.row_count++;
+	}
+
+	if (cursor.step_result != SQLITE_ROW && cursor.step_result != SQLITE_DONE) {
+		const std::string sqlerror_message = sqlite3_errmsg (cursor.db);
+
+		if (sqlerror_message.empty() == false) {
+			const std::string sqlerror_text = sqlite3_errstr (cursor.step_result);
+
+			std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") MESSAGE: " << sqlerror_message << "\n";
+			std::cout << "\t\t\t\t\t" << sqlerror_text << "\n";
+		}
+	}
+
+	return (cursor.step_result == SQLITE_ROW);
+}
+
+int
+gautier_rss_database::get_column_count (sql_cursor& cursor)
+{
+	return sqlite3_data_count (cursor.statement);
+}
+
+std::string_view
+gautier_rss_database::get_column_text (sql_cursor& cursor, const int col_index)
+{
+	std::string_view value;
+
+	const unsigned char* col_text = sqlite3_column_text (cursor.statement, col_index);
+
+	if (col_text) {
+		const int col_size = sqlite3_column_bytes (cursor.statement, col_index);
+
+		value = std::string_view ((const char*)col_text, (size_t)col_size);
+	}
+
+	return value;
+}
+
+int64_t
+gautier_rss_database::get_column_int64 (sql_cursor& cursor, const int col_index)
+{
+	return (int64_t) (sqlite3_column_int64 (cursor.statement, col_index));
+}
+
+bool
+gautier_rss_database::is_column_null (sql_cursor& cursor, const int col_index)
+{
+	return (sqlite3_column_type (cursor.statement, col_index) == SQLITE_NULL);
+}
+
+bool
+gautier_rss_database::is_column_blob (sql_cursor& cursor, const int col_index)
+{
+	return (sqlite3_column_type (cursor.statement, col_index) == SQLITE_BLOB);
 }
 
 void
-gautier_rss_database::close_db (sqlite3** db)
+gautier_rss_database::close_cursor (sql_cursor& cursor)
 {
-	if (db) {
-		sqlite3_close_v2 (*db);
+	if (cursor.statement && statement_profiling_enabled) {
+		add_statement_profile (cursor.sql_text, cursor.statement, cursor.step_nanoseconds, cursor.row_count);
+
+		timed_cursor_statement = cursor.statement;
+
+		release_statement (cursor.db, cursor.sql_text, cursor.statement, cursor.cached);
+
+		timed_cursor_statement = nullptr;
+	} else if (cursor.statement) {
+		release_statement (cursor.db, cursor.sql_text, cursor.statement, cursor.cached);
 	}
 
+	cursor.statement = nullptr;
+	cursor.cached = false;
+
 	return;
 }
 
-int
-gautier_rss_database::create_sql_row (void* generic_object, const int col_count, char** col_values,
-                                      char** col_names)
+bool
+gautier_rss_database::process_sql (sqlite3** db, const std::string sql_text,
+                                   sql_parameter_list_type sql_param_values, sql_rowset_type& rows)
 {
-	sql_rowset_type* rows = (sql_rowset_type*)generic_object;
+	sql_cursor cursor;
 
-	rows->emplace_back (sql_row_type());
+	const bool cursor_open = open_cursor (db, sql_text, sql_param_values, cursor);
 
-	sql_row_type* row = & (rows->back());
+	if (cursor_open == false) {
+		return false;
+	}
 
-	for (int i = 0; i < col_count; i++) {
-		const std::string name = col_names[i];
-		const std::string value = (col_values[i] ? col_values[i] : "");
+	while (next_row (cursor)) {
+		const int col_count = get_column_count (cursor);
 
-		row->insert_or_assign (name, value);
+		rows.emplace_back (sql_row_type());
+
+		sql_row_type* row = & (rows.back());
+
+		for (int col_i = 0; col_i < col_count; col_i++) {
+			const std::string col_name = sqlite3_column_name (cursor.statement, col_i);
+
+			row->insert_or_assign (col_name, std::string (get_column_text (cursor, col_i)));
+		}
 	}
 
-	return 0;
+	const bool completed = (cursor.step_result == SQLITE_DONE);
+
+	close_cursor (cursor);
+
+	return completed;
+}
+
+bool
+gautier_rss_database::process_sql (sqlite3** db, const std::string sql_text,
+                                   sql_parameter_list_type sql_param_values)
+{
+	sql_rowset_type rows;
+
+	return process_sql (db, sql_text, sql_param_values, rows);
+}
+
+gautier_rss_database::sql_statement_cache_stats
+gautier_rss_database::get_statement_cache_stats (const std::string db_file_name)
+{
+	sql_statement_cache_stats stats;
+
+	std::vector<sqlite3*> connections;
+	{
+		std::lock_guard<std::mutex> sessions_guard (db_sessions_lock);
+
+		const size_t session_count = db_sessions.count (db_file_name);
+
+		if (session_count > 0) {
+			db_session* session = &db_sessions[db_file_name];
+
+			connections = session->idle_readers;
+			connections.push_back (session->writer);
+		}
+	}
+
+	std::lock_guard<std::mutex> cache_guard (statement_caches_lock);
+
+	for (sqlite3* db : connections) {
+		const size_t cache_count = statement_caches.count (db);
+
+		if (cache_count > 0) {
+			sql_statement_cache* cache = &statement_caches[db];
+
+			stats.hits += cache->hits;
+			stats.misses += cache->misses;
+			stats.statement_count += (int64_t) (cache->statements.size());
+		}
+	}
+
+	return stats;
 }
 
 void
-gautier_rss_database::process_sql_simple (sqlite3** db, const std::string sql_text, sql_rowset_type& rows)
+gautier_rss_database::start_write_queue (const std::string db_file_name,
+        const int64_t max_commit_delay_in_milliseconds, const size_t max_batch_size)
 {
-	sql_rowset_type* tmp_rows = &rows;
+	std::lock_guard<std::mutex> queues_guard (write_queues_lock);
 
-	char* error_message;
+	const size_t queue_count = write_queues.count (db_file_name);
 
-	sqlite3_exec (*db, sql_text.data(), create_sql_row, (void*)tmp_rows, &error_message);
+	if (queue_count > 0) {
+		return;
+	}
+
+	/*
+		The queue holds the session open until it stops.
+	*/
+	if (open_session (db_file_name) == false) {
+		return;
+	}
+
+	std::unique_ptr<sql_write_queue> queue = std::make_unique<sql_write_queue>();
+
+	queue->db_file_name = db_file_name;
+	queue->max_commit_delay = std::chrono::milliseconds (std::max<int64_t> (0, max_commit_delay_in_milliseconds));
+	queue->max_batch_size = std::max<size_t> (1, max_batch_size);
+	queue->thread = std::thread (run_write_queue, queue.get());
+
+	write_queues[db_file_name] = std::move (queue);
 
 	return;
 }
 
+std::future<bool>
+gautier_rss_database::queue_write (const std::string db_file_name, sql_write_operation_type operation)
+{
+	sql_queued_write write;
+
+	write.operation = operation;
+	write.queued_time = std::chrono::steady_clock::now();
+
+	std::future<bool> committed = write.committed.get_future();
+
+	{
+		std::lock_guard<std::mutex> queues_guard (write_queues_lock);
+
+		const size_t queue_count = write_queues.count (db_file_name);
+
+		if (queue_count > 0) {
+			sql_write_queue* queue = write_queues[db_file_name].get();
+
+			std::lock_guard<std::mutex> queue_guard (queue->lock);
+
+			queue->writes.push_back (std::move (write));
+
+			queue->signal.notify_one();
+
+			return committed;
+		}
+	}
+
+	/*
+		No queue. Write now on this thread, in one transaction.
+		A caller already inside a transaction keeps it open. The write runs in a savepoint.
+	*/
+	sqlite3* db = acquire_writer (db_file_name);
+
+	bool transaction_committed = false;
+
+	if (db) {
+		const bool in_transaction = is_in_transaction (db);
+
+		const bool transaction_started = begin_transaction (&db);
+
+		if (transaction_started || in_transaction) {
+			write.succeeded = run_write_operation (&db, write.operation);
+
+			if (write.succeeded) {
+				transaction_committed = commit_transaction (&db, transaction_started);
+			} else {
+				rollback_transaction (&db, transaction_started);
+			}
+		}
+
+		release_writer (db_file_name);
+	}
+
+	write.committed.set_value (transaction_committed && write.succeeded);
+
+	return committed;
+}
+
 void
-gautier_rss_database::process_sql_simple (sqlite3** db, const std::string sql_text)
+gautier_rss_database::stop_write_queue (const std::string db_file_name)
 {
-	char* error_message;
+	std::unique_ptr<sql_write_queue> queue;
+	{
+		std::lock_guard<std::mutex> queues_guard (write_queues_lock);
 
-	sqlite3_exec (*db, sql_text.data(), nullptr, nullptr, &error_message);
+		const size_t queue_count = write_queues.count (db_file_name);
 
-	if (error_message) {
-		std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") SQL Result: " << error_message <<
-		          "\n\n";
+		if (queue_count > 0) {
+			queue = std::move (write_queues[db_file_name]);
+
+			write_queues.erase (db_file_name);
+		}
+	}
+
+	if (queue) {
+		{
+			std::lock_guard<std::mutex> queue_guard (queue->lock);
+
+			queue->stopping = true;
+
+			queue->signal.notify_one();
+		}
+
+		queue->thread.join();
+
+		close_session (db_file_name);
 	}
 
 	return;
 }
 
 void
-gautier_rss_database::process_sql (sqlite3** db, const std::string sql_text,
-                                   sql_parameter_list_type sql_param_values, sql_rowset_type& rows)
+gautier_rss_database::set_statement_profiling (const bool enabled)
 {
-	sqlite3_stmt* sql_statement;
+	statement_profiling_enabled = enabled;
 
-	int prepare_result = sqlite3_prepare_v2 (*db,  sql_text.data(),  -1,  &sql_statement,  nullptr);
+	return;
+}
 
-	if (prepare_result != SQLITE_OK) {
-		std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") SQL Prepare Result: " << prepare_result
-		          << "\n\n";
-	}
+bool
+gautier_rss_database::is_statement_profiling_enabled()
+{
+	return statement_profiling_enabled;
+}
 
-	int i = 0;
+gautier_rss_database::sql_statement_profile_list_type
+gautier_rss_database::get_statement_profiles()
+{
+	sql_statement_profile_list_type profiles;
 
-	for (sql_parameter_list_type::value_type& sql_parameter : sql_param_values) {
-		i++;
-		sqlite3_bind_text (sql_statement, i, sql_parameter.data(), -1, SQLITE_TRANSIENT);
+	std::lock_guard<std::mutex> profiles_guard (statement_profiles_lock);
+
+	for (const auto& [sql_text, profile_data] : statement_profiles) {
+		if (profile_data.call_count < 1) {
+			continue;
+		}
+
+		sql_statement_profile profile;
+
+		profile.sql_text = sql_text;
+		profile.call_count = profile_data.call_count;
+		profile.total_nanoseconds = profile_data.total_nanoseconds;
+		profile.p50_nanoseconds = get_latency_percentile (profile_data, 50);
+		profile.p95_nanoseconds = get_latency_percentile (profile_data, 95);
+		profile.p99_nanoseconds = get_latency_percentile (profile_data, 99);
+		profile.max_nanoseconds = profile_data.max_nanoseconds;
+		profile.rows_stepped = profile_data.rows_stepped;
+		profile.full_scan_steps = profile_data.full_scan_steps;
+		profile.sort_count = profile_data.sort_count;
+		profile.vm_steps = profile_data.vm_steps;
+
+		profiles.push_back (profile);
 	}
 
-	int sql_result = sqlite3_step (sql_statement);
+	std::sort (profiles.begin(), profiles.end(), [] (const sql_statement_profile & a, const sql_statement_profile & b) {
+		return (a.total_nanoseconds > b.total_nanoseconds);
+	});
+
+	return profiles;
+}
 
-	while (sql_result == SQLITE_OK || sql_result == SQLITE_ROW) {
-		if (sql_result == SQLITE_OK || sql_result == SQLITE_ROW) {
-			const int col_count = sqlite3_data_count (sql_statement);
+void
+gautier_rss_database::reset_statement_profiles()
+{
+	std::lock_guard<std::mutex> profiles_guard (statement_profiles_lock);
 
-			rows.emplace_back (sql_row_type());
+	statement_profiles.clear();
 
-			sql_row_type* row = & (rows.back());
+	return;
+}
 
-			for (int col_i = 0; col_i < col_count; col_i++) {
-				std::string col_name = sqlite3_column_name (sql_statement, col_i);
+void
+gautier_rss_database::print_statement_profiles()
+{
+	const sql_statement_profile_list_type profiles = get_statement_profiles();
 
-				std::stringstream col_value;
+	const size_t sql_text_display_max = 96;
 
-				col_value << sqlite3_column_text (sql_statement, col_i);
+	std::cout << "SQL statement profile (" << profiles.size() << " statements, times in microseconds)\n";
+	std::cout << std::setw (8) << "calls" << std::setw (12) << "total" << std::setw (10) << "p50" <<
+	          std::setw (10) << "p95" << std::setw (10) << "p99" << std::setw (10) << "max" <<
+	          std::setw (10) << "rows" << std::setw (10) << "scans" << std::setw (8) << "sorts" << "  sql\n";
 
-				row->insert_or_assign (col_name, col_value.str());
-			}
+	for (const sql_statement_profile& profile : profiles) {
+		/*
+			SQL text in this program spans many lines. Show it on one line with runs of whitespace collapsed.
+		*/
+		std::string sql_text;
 
-			sql_result = sqlite3_step (sql_statement);
-		} else if (sql_result == SQLITE_DONE) {
-			sqlite3_reset (sql_statement);
+		for (const char c : profile.sql_text) {
+			const bool is_space = std::isspace ((unsigned char)c);
 
-			break;
-		} else {
-			const std::string sqlerror_message = sqlite3_errmsg (*db);
+			if (is_space && (sql_text.empty() || sql_text.back() == ' ')) {
+				continue;
+			}
 
-			if (sqlerror_message.empty() == false) {
-				const std::string sqlerror_text = sqlite3_errstr (sql_result);
+			sql_text.push_back (is_space ? ' ' : c);
 
-				std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") MESSAGE: " << sqlerror_message << "\n";
-				std::cout << "\t\t\t\t\t" << sqlerror_text << "\n";
+			if (sql_text.size() >= sql_text_display_max) {
+				sql_text.append ("...");
+				break;
 			}
 		}
-	}
 
-	sqlite3_finalize (sql_statement);
+		std::cout << std::setw (8) << profile.call_count <<
+		          std::setw (12) << (profile.total_nanoseconds / 1000) <<
+		          std::setw (10) << (profile.p50_nanoseconds / 1000) <<
+		          std::setw (10) << (profile.p95_nanoseconds / 1000) <<
+		          std::setw (10) << (profile.p99_nanoseconds / 1000) <<
+		          std::setw (10) << (profile.max_nanoseconds / 1000) <<
+		          std::setw (10) << profile.rows_stepped <<
+		          std::setw (10) << profile.full_scan_steps <<
+		          std::setw (8) << profile.sort_count << "  " << sql_text << "\n";
+	}
 
 	return;
 }
 
-void
-gautier_rss_database::process_sql (sqlite3** db, const std::string sql_text,
-                                   sql_parameter_list_type sql_param_values)
+bool
+gautier_rss_database::begin_transaction (sqlite3** db)
 {
-	sql_rowset_type rows;
+	bool transaction_started = false;
+
+	const bool in_transaction = (sqlite3_get_autocommit (*db) == 0);
+
+	if (in_transaction == false) {
+		transaction_started = execute_sql (*db, "BEGIN IMMEDIATE;");
+	}
+
+	return transaction_started;
+}
+
+bool
+gautier_rss_database::commit_transaction (sqlite3** db, const bool transaction_started)
+{
+	bool success = true;
+
+	if (transaction_started) {
+		success = execute_sql (*db, "COMMIT;");
+
+		if (success == false) {
+			execute_sql (*db, "ROLLBACK;");
+		}
+	}
+
+	return success;
+}
 
-	process_sql (db, sql_text, sql_param_values, rows);
+void
+gautier_rss_database::rollback_transaction (sqlite3** db, const bool transaction_started)
+{
+	if (transaction_started) {
+		execute_sql (*db, "ROLLBACK;");
+	}
 
 	return;
 }
+
+int64_t
+gautier_rss_database::get_changed_row_count (sqlite3** db)
+{
+	return (int64_t) (sqlite3_changes64 (*db));
+}
+
+int64_t
+gautier_rss_database::get_schema_version (sqlite3** db)
+{
+	int64_t schema_version = 0;
+
+	sql_cursor cursor;
+
+	if (open_cursor (db, "PRAGMA user_version;", sql_parameter_list_type(), cursor)) {
+		if (next_row (cursor)) {
+			schema_version = get_column_int64 (cursor, 0);
+		}
+
+		close_cursor (cursor);
+	}
+
+	return schema_version;
+}
+
+bool
+gautier_rss_database::migrate_schema (sqlite3** db, const sql_migration_list_type& migrations)
+{
+	bool success = true;
+
+	int64_t schema_version = get_schema_version (db);
+
+	/*
+		Migrations may rebuild tables referenced by foreign keys.
+		Enforcement is suspended while they run and checked before each commit.
+		The pragma has no effect inside a transaction so it is set out here.
+	*/
+	bool foreign_keys_enabled = false;
+	{
+		sqlite3_stmt* statement = nullptr;
+
+		if (sqlite3_prepare_v2 (*db, "PRAGMA foreign_keys;", -1, &statement, nullptr) == SQLITE_OK) {
+			if (sqlite3_step (statement) == SQLITE_ROW) {
+				foreign_keys_enabled = (sqlite3_column_int (statement, 0) == 1);
+			}
+		}
+
+		sqlite3_finalize (statement);
+	}
+
+	if (foreign_keys_enabled) {
+		execute_sql (*db, "PRAGMA foreign_keys = OFF;");
+	}
+
+	for (const sql_migration& migration : migrations) {
+		if (migration.version <= schema_version) {
+			continue;
+		}
+
+		success = execute_sql (*db, "BEGIN IMMEDIATE;");
+
+		for (const std::string& sql_text : migration.sql_texts) {
+			if (success) {
+				success = execute_sql (*db, sql_text);
+			}
+		}
+
+		if (success) {
+			success = has_valid_foreign_keys (*db);
+		}
+
+		if (success) {
+			success = execute_sql (*db, "PRAGMA user_version = " + std::to_string (migration.version) + ";");
+		}
+
+		if (success) {
+			success = execute_sql (*db, "COMMIT;");
+		}
+
+		if (success == false) {
+			execute_sql (*db, "ROLLBACK;");
+
+			std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") Schema migration to version " <<
+			          migration.version << " failed. Schema remains at version " << schema_version << "\n\n";
+
+			break;
+		}
+
+		schema_version = migration.version;
+	}
+
+	if (foreign_keys_enabled) {
+		execute_sql (*db, "PRAGMA foreign_keys = ON;");
+	}
+
+	return success;
+}
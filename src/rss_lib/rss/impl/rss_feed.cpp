@@ -29,12 +29,18 @@ bool
 gautier_rss_data_read::is_feed_still_fresh (const std::string db_file_name, const std::string feed_name,
         const bool time_message_stdout)
 {
-	bool fresh = true;
-
 	rss_feed feed;
 
 	get_feed (db_file_name, feed_name, feed);
 
+	return is_feed_still_fresh (feed, time_message_stdout);
+}
+
+bool
+gautier_rss_data_read::is_feed_still_fresh (const rss_feed& feed, const bool time_message_stdout)
+{
+	bool fresh = true;
+
 	if (feed.feed_name.empty() == false) {
 		std::string current_date_time_utc = gautier_rss_util::get_current_date_time_utc();
 
@@ -10,6 +10,7 @@ You should have received a copy of the GNU Lesser General Public License along w
 Author: Michael Gautier <michaelgautier.wordpress.com>
 */
 
+#include <cctype>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
@@ -22,114 +23,167 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <vector>
 
 #include "rss_lib/rss/rss_reader.hpp"
+#include "rss_lib/rss/rss_util.hpp"
 #include "rss_lib/db/db.hpp"
 
+namespace ns_db = gautier_rss_database;
+
 namespace {
 	void
-	create_feed_from_sql_row (gautier_rss_database::sql_row_type& row, gautier_rss_data_read::rss_feed& feed);
+	create_feed_from_sql_row (ns_db::sql_cursor& cursor, gautier_rss_data_read::rss_feed& feed);
 
 	void
-	create_article_from_sql_row (gautier_rss_database::sql_row_type& row,
-	                             gautier_rss_data_read::rss_article& article);
+	create_article_from_sql_row (ns_db::sql_cursor& cursor, gautier_rss_data_read::rss_article& article);
+
+	std::string
+	create_search_query (const std::string& search_text);
 
 	void
-	create_headline_text_from_sql_row (gautier_rss_database::sql_row_type& row, std::string& headline_text);
+	get_article_body (ns_db::sql_cursor& cursor, const int col_index, std::string& text);
 
+	/*
+		Article summary and text may be stored compressed (a BLOB).
+		They are only expanded here, when a caller asks for the body.
+	*/
 	void
-	create_feed_from_sql_row (gautier_rss_database::sql_row_type& row, gautier_rss_data_read::rss_feed& feed)
+	get_article_body (ns_db::sql_cursor& cursor, const int col_index, std::string& text)
 	{
-		for (auto [name, value] : row) {
-			if (name == "feed_name") {
-				feed.feed_name = value;
-			} else if (name == "feed_url") {
-				feed.feed_url = value;
-			} else if (name == "last_retrieved") {
-				feed.last_retrieved = value;
-			} else if (name == "retrieve_limit_hrs") {
-				feed.retrieve_limit_hrs = value;
-			} else if (name == "retention_days") {
-				feed.retention_days = value;
-			} else if (name == "article_count") {
-				feed.article_count = std::stoll (value);
-			}
+		/*Type is checked first. Reading the value can change the type SQLite reports.*/
+		const bool is_compressed = ns_db::is_column_blob (cursor, col_index);
+
+		const std::string_view value = ns_db::get_column_text (cursor, col_index);
+
+		if (is_compressed) {
+			gautier_rss_util::decompress_text (value, text);
+		} else {
+			text = value;
 		}
 
 		return;
 	}
 
+	/*
+		Column order:	feed_name, feed_url, last_retrieved,
+				retrieve_limit_hrs, retention_days, article_count,
+				feed_id
+	*/
 	void
-	create_article_from_sql_row (gautier_rss_database::sql_row_type& row,
-	                             gautier_rss_data_read::rss_article& article)
+	create_feed_from_sql_row (ns_db::sql_cursor& cursor, gautier_rss_data_read::rss_feed& feed)
 	{
-		for (auto [name, value] : row) {
-			if (name == "feed_name") {
-				article.feed_name = value;
-			} else if (name == "headline_text") {
-				article.headline = value;
-			} else if (name == "article_summary") {
-				article.article_summary = value;
-			} else if (name == "article_text") {
-				article.article_text = value;
-			} else if (name == "article_date") {
-				article.article_date = value;
-			} else if (name == "article_url") {
-				article.url = value;
-			}
-		}
+		feed.feed_name = ns_db::get_column_text (cursor, 0);
+		feed.feed_url = ns_db::get_column_text (cursor, 1);
+		feed.last_retrieved = ns_db::get_column_text (cursor, 2);
+		feed.retrieve_limit_hrs = ns_db::get_column_text (cursor, 3);
+		feed.retention_days = ns_db::get_column_text (cursor, 4);
+		feed.article_count = ns_db::get_column_int64 (cursor, 5);
+		feed.row_id = ns_db::get_column_int64 (cursor, 6);
 
 		return;
 	}
 
+	/*
+		Column order:	feed_name, headline_text, article_summary,
+				article_text, article_date, article_url,
+				article_date_epoch
+	*/
 	void
-	create_headline_text_from_sql_row (gautier_rss_database::sql_row_type& row, std::string& headline_text)
+	create_article_from_sql_row (ns_db::sql_cursor& cursor, gautier_rss_data_read::rss_article& article)
+	{
+		article.feed_name = ns_db::get_column_text (cursor, 0);
+		article.headline = ns_db::get_column_text (cursor, 1);
+		get_article_body (cursor, 2, article.article_summary);
+		get_article_body (cursor, 3, article.article_text);
+		article.article_date = ns_db::get_column_text (cursor, 4);
+		article.url = ns_db::get_column_text (cursor, 5);
+		article.article_date_epoch = ns_db::get_column_int64 (cursor, 6);
+
+		return;
+	}
+
+	/*
+		Turns user input into an FTS5 query.
+
+		Each word is quoted so punctuation and FTS5 operators in the input are searched as text.
+		Words are joined by implicit AND. The last word is a prefix match.
+	*/
+	std::string
+	create_search_query (const std::string& search_text)
 	{
-		for (auto [name, value] : row) {
-			if (name == "headline_text") {
-				headline_text = value;
+		std::string query;
 
+		size_t char_index = 0;
+		const size_t char_count = search_text.size();
+
+		while (char_index < char_count) {
+			while (char_index < char_count && std::isspace ((unsigned char) (search_text[char_index]))) {
+				char_index++;
+			}
+
+			if (char_index == char_count) {
 				break;
 			}
+
+			if (query.empty() == false) {
+				query.push_back (' ');
+			}
+
+			query.push_back ('"');
+
+			while (char_index < char_count && std::isspace ((unsigned char) (search_text[char_index])) == false) {
+				const char character = search_text[char_index];
+
+				if (character == '"') {
+					query.push_back ('"');
+				}
+
+				query.push_back (character);
+
+				char_index++;
+			}
+
+			query.push_back ('"');
 		}
 
-		return;
+		if (query.empty() == false) {
+			query.push_back ('*');
+		}
+
+		return query;
 	}
 }
 
 void
 gautier_rss_data_read::get_feed (const std::string db_file_name, const std::string feed_name, rss_feed& feed)
 {
-	namespace ns_db = gautier_rss_database;
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
-
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
 			f.feed_name, f.feed_url, \
 			f.last_retrieved, f.retrieve_limit_hrs, f.retention_days, \
-			COUNT(fa.rowid) AS article_count \
-		FROM feeds AS f LEFT OUTER JOIN \
-			feeds_articles AS fa ON f.feed_name = fa.feed_name \
-		WHERE f.feed_name = @feed_name \
-		GROUP BY f.feed_name, f.feed_url, \
-			f.last_retrieved, f.retrieve_limit_hrs, f.retention_days;";
+			f.article_count, f.feed_id \
+		FROM feeds AS f \
+		WHERE f.feed_name = @feed_name;";
 
 	ns_db::sql_parameter_list_type params = {
 		feed_name
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		rss_feed feed_info;
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_feed feed_info;
 
-		create_feed_from_sql_row (row, feed_info);
+			create_feed_from_sql_row (cursor, feed_info);
 
-		feed = feed_info;
+			feed = feed_info;
+		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -137,38 +191,35 @@ gautier_rss_data_read::get_feed (const std::string db_file_name, const std::stri
 void
 gautier_rss_data_read::get_feed_by_row_id (const std::string db_file_name, const int64_t row_id, rss_feed& feed)
 {
-	namespace ns_db = gautier_rss_database;
-
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
 			f.feed_name, f.feed_url, \
 			f.last_retrieved, f.retrieve_limit_hrs, f.retention_days, \
-			COUNT(fa.rowid) AS article_count \
-		FROM feeds AS f LEFT OUTER JOIN \
-			feeds_articles AS fa ON f.feed_name = fa.feed_name \
-		WHERE f.rowid = @row_id \
-		GROUP BY f.feed_name, f.feed_url, \
-			f.last_retrieved, f.retrieve_limit_hrs, f.retention_days;";
+			f.article_count, f.feed_id \
+		FROM feeds AS f \
+		WHERE f.feed_id = @row_id;";
 
 	ns_db::sql_parameter_list_type params = {
 		std::to_string (row_id)
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		rss_feed feed_info;
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_feed feed_info;
 
-		create_feed_from_sql_row (row, feed_info);
+			create_feed_from_sql_row (cursor, feed_info);
 
-		feed = feed_info;
+			feed = feed_info;
+		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -176,38 +227,31 @@ gautier_rss_data_read::get_feed_by_row_id (const std::string db_file_name, const
 void
 gautier_rss_data_read::get_feeds (const std::string db_file_name, feeds_list_type& feeds)
 {
-	namespace ns_db = gautier_rss_database;
-
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
 			f.feed_name, f.feed_url, \
 			f.last_retrieved, f.retrieve_limit_hrs, f.retention_days, \
-			COUNT(fa.rowid) AS article_count \
-		FROM feeds AS f LEFT OUTER JOIN \
-			feeds_articles AS fa ON f.feed_name = fa.feed_name \
-		GROUP BY f.feed_name, f.feed_url, \
-			f.last_retrieved, f.retrieve_limit_hrs, f.retention_days \
+			f.article_count, f.feed_id \
+		FROM feeds AS f \
 		ORDER BY f.feed_name, f.feed_url;";
 
 	ns_db::sql_parameter_list_type params;
 
-	ns_db::process_sql (&db, sql_text, params, rows);
-
-	feeds.reserve (rows.size());
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		rss_feed feed;
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_feed& feed = feeds.emplace_back (rss_feed());
 
-		create_feed_from_sql_row (row, feed);
+			create_feed_from_sql_row (cursor, feed);
+		}
 
-		feeds.emplace_back (feed);
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -216,10 +260,18 @@ void
 gautier_rss_data_read::get_feed_articles (const std::string db_file_name, const std::string feed_name,
         articles_list_type& headlines, const bool descending)
 {
-	namespace ns_db = gautier_rss_database;
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	get_feed_articles (db_file_name, feed_id, headlines, descending);
+
+	return;
+}
+
+void
+gautier_rss_data_read::get_feed_articles (const std::string db_file_name, const int64_t feed_id,
+        articles_list_type& headlines, const bool descending)
+{
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
 	std::string sort_direction = "ASC";
 
@@ -227,35 +279,36 @@ gautier_rss_data_read::get_feed_articles (const std::string db_file_name, const
 		sort_direction = "DESC";
 	}
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
-			feed_name, headline_text, \
-			article_summary, article_text, \
-			article_date, article_url \
-		FROM feeds_articles \
-		WHERE feed_name = @feed_name \
-		ORDER BY rowid " + sort_direction + ";";
+			f.feed_name, fa.headline_text, \
+			b.article_summary, b.article_text, \
+			fa.article_date, fa.article_url, fa.article_date_epoch \
+		FROM feeds_articles AS fa INNER JOIN \
+			feeds AS f ON f.feed_id = fa.feed_id LEFT OUTER JOIN \
+			feeds_articles_body AS b ON b.article_id = fa.article_id \
+		WHERE fa.feed_id = @feed_id \
+		ORDER BY fa.article_date_epoch " + sort_direction + ", fa.article_id " + sort_direction + ";";
 
 	ns_db::sql_parameter_list_type params = {
-		feed_name
+		std::to_string (feed_id)
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
-
-	headlines.reserve (rows.size());
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		rss_article article;
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_article article;
 
-		create_article_from_sql_row (row, article);
+			create_article_from_sql_row (cursor, article);
 
-		if (article.feed_name.empty() == false && article.feed_name == feed_name) {
-			headlines.emplace_back (article);
+			headlines.emplace_back (std::move (article));
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -264,10 +317,18 @@ void
 gautier_rss_data_read::get_feed_headlines (const std::string db_file_name, const std::string feed_name,
         headlines_list_type& headlines, const bool descending)
 {
-	namespace ns_db = gautier_rss_database;
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	get_feed_headlines (db_file_name, feed_id, headlines, descending);
+
+	return;
+}
+
+void
+gautier_rss_data_read::get_feed_headlines (const std::string db_file_name, const int64_t feed_id,
+        headlines_list_type& headlines, const bool descending)
+{
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
 	std::string sort_direction = "ASC";
 
@@ -275,33 +336,32 @@ gautier_rss_data_read::get_feed_headlines (const std::string db_file_name, const
 		sort_direction = "DESC";
 	}
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
 			headline_text \
 		FROM feeds_articles \
-		WHERE feed_name = @feed_name \
-		ORDER BY rowid " + sort_direction + ";";
+		WHERE feed_id = @feed_id \
+		ORDER BY article_date_epoch " + sort_direction + ", rowid " + sort_direction + ";";
 
 	ns_db::sql_parameter_list_type params = {
-		feed_name
+		std::to_string (feed_id)
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
-
-	headlines.reserve (rows.size());
-
-	for (ns_db::sql_row_type row : rows) {
-		std::string headline_text;
+	ns_db::sql_cursor cursor;
 
-		create_headline_text_from_sql_row (row, headline_text);
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			const std::string_view headline_text = ns_db::get_column_text (cursor, 0);
 
-		if (headline_text.empty() == false) {
-			headlines.emplace_back (headline_text);
+			if (headline_text.empty() == false) {
+				headlines.emplace_back (headline_text);
+			}
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -311,10 +371,19 @@ gautier_rss_data_read::get_feed_articles_after_row_id (const std::string db_file
         const std::string feed_name,
         articles_list_type& headlines, const bool descending, const int64_t row_id)
 {
-	namespace ns_db = gautier_rss_database;
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
+
+	get_feed_articles_after_row_id (db_file_name, feed_id, headlines, descending, row_id);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	return;
+}
+
+void
+gautier_rss_data_read::get_feed_articles_after_row_id (const std::string db_file_name,
+        const int64_t feed_id,
+        articles_list_type& headlines, const bool descending, const int64_t row_id)
+{
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
 	std::string sort_direction = "ASC";
 
@@ -322,36 +391,87 @@ gautier_rss_data_read::get_feed_articles_after_row_id (const std::string db_file
 		sort_direction = "DESC";
 	}
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
-			feed_name, headline_text, \
-			article_summary, article_text, \
-			article_date, article_url \
-		FROM feeds_articles \
-		WHERE feed_name = @feed_name and rowid > @rowid \
-		ORDER BY rowid " + sort_direction + ";";
+			f.feed_name, fa.headline_text, \
+			b.article_summary, b.article_text, \
+			fa.article_date, fa.article_url, fa.article_date_epoch \
+		FROM feeds_articles AS fa INNER JOIN \
+			feeds AS f ON f.feed_id = fa.feed_id LEFT OUTER JOIN \
+			feeds_articles_body AS b ON b.article_id = fa.article_id \
+		WHERE fa.feed_id = @feed_id AND fa.article_id > @rowid \
+		ORDER BY fa.article_date_epoch " + sort_direction + ", fa.article_id " + sort_direction + ";";
 
 	ns_db::sql_parameter_list_type params = {
-		feed_name,
+		std::to_string (feed_id),
 		std::to_string (row_id)
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	ns_db::sql_cursor cursor;
+
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_article article;
+
+			create_article_from_sql_row (cursor, article);
+
+			headlines.emplace_back (std::move (article));
+		}
+
+		ns_db::close_cursor (cursor);
+	}
+
+	ns_db::release_reader (db_file_name, db);
 
-	headlines.reserve (rows.size());
+	return;
+}
 
-	for (ns_db::sql_row_type row : rows) {
-		rss_article article;
+void
+gautier_rss_data_read::get_feed_articles_by_date (const std::string db_file_name, const int64_t feed_id,
+        const int64_t from_epoch_seconds, const int64_t to_epoch_seconds,
+        articles_list_type& articles, const bool descending)
+{
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-		create_article_from_sql_row (row, article);
+	std::string sort_direction = "ASC";
 
-		if (article.feed_name.empty() == false && article.feed_name == feed_name) {
-			headlines.emplace_back (article);
+	if (descending) {
+		sort_direction = "DESC";
+	}
+
+	const std::string sql_text =
+	    "SELECT \
+			f.feed_name, fa.headline_text, \
+			b.article_summary, b.article_text, \
+			fa.article_date, fa.article_url, fa.article_date_epoch \
+		FROM feeds_articles AS fa INNER JOIN \
+			feeds AS f ON f.feed_id = fa.feed_id LEFT OUTER JOIN \
+			feeds_articles_body AS b ON b.article_id = fa.article_id \
+		WHERE fa.feed_id = @feed_id \
+			AND fa.article_date_epoch BETWEEN @from_epoch AND @to_epoch \
+		ORDER BY fa.article_date_epoch " + sort_direction + ", fa.article_id " + sort_direction + ";";
+
+	ns_db::sql_parameter_list_type params = {
+		std::to_string (feed_id),
+		std::to_string (from_epoch_seconds),
+		std::to_string (to_epoch_seconds)
+	};
+
+	ns_db::sql_cursor cursor;
+
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_article article;
+
+			create_article_from_sql_row (cursor, article);
+
+			articles.emplace_back (std::move (article));
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -361,10 +481,19 @@ gautier_rss_data_read::get_feed_headlines_after_row_id (const std::string db_fil
         const std::string feed_name,
         headlines_list_type& headlines, const bool descending, const int64_t row_id)
 {
-	namespace ns_db = gautier_rss_database;
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	get_feed_headlines_after_row_id (db_file_name, feed_id, headlines, descending, row_id);
+
+	return;
+}
+
+void
+gautier_rss_data_read::get_feed_headlines_after_row_id (const std::string db_file_name,
+        const int64_t feed_id,
+        headlines_list_type& headlines, const bool descending, const int64_t row_id)
+{
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
 	std::string sort_direction = "ASC";
 
@@ -372,34 +501,33 @@ gautier_rss_data_read::get_feed_headlines_after_row_id (const std::string db_fil
 		sort_direction = "DESC";
 	}
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
 			headline_text \
 		FROM feeds_articles \
-		WHERE feed_name = @feed_name and rowid > @rowid \
-		ORDER BY rowid " + sort_direction + ";";
+		WHERE feed_id = @feed_id AND rowid > @rowid \
+		ORDER BY article_date_epoch " + sort_direction + ", rowid " + sort_direction + ";";
 
 	ns_db::sql_parameter_list_type params = {
-		feed_name,
+		std::to_string (feed_id),
 		std::to_string (row_id)
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
-
-	headlines.reserve (rows.size());
-
-	for (ns_db::sql_row_type row : rows) {
-		std::string headline_text;
+	ns_db::sql_cursor cursor;
 
-		create_headline_text_from_sql_row (row, headline_text);
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			const std::string_view headline_text = ns_db::get_column_text (cursor, 0);
 
-		if (headline_text.empty() == false) {
-			headlines.emplace_back (headline_text);
+			if (headline_text.empty() == false) {
+				headlines.emplace_back (headline_text);
+			}
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
@@ -408,86 +536,132 @@ void
 gautier_rss_data_read::get_feed_article_summary (const std::string db_file_name, const std::string feed_name,
         const std::string headline, rss_article& article)
 {
-	namespace ns_db = gautier_rss_database;
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	get_feed_article_summary (db_file_name, feed_id, headline, article);
+
+	if (article.feed_name.empty()) {
+		article.feed_name = feed_name;
+	}
+
+	return;
+}
+
+void
+gautier_rss_data_read::get_feed_article_summary (const std::string db_file_name, const int64_t feed_id,
+        const std::string headline, rss_article& article)
+{
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
-			article_summary, article_text, \
-			article_date, article_url \
-		FROM feeds_articles \
-		WHERE feed_name = @feed_name \
-			AND headline_text = @headline_text";
+			b.article_summary, b.article_text, \
+			fa.article_date, fa.article_url, \
+			f.feed_name, fa.article_date_epoch \
+		FROM feeds_articles AS fa INNER JOIN \
+			feeds AS f ON f.feed_id = fa.feed_id LEFT OUTER JOIN \
+			feeds_articles_body AS b ON b.article_id = fa.article_id \
+		WHERE fa.feed_id = @feed_id \
+			AND fa.headline_text = @headline_text";
 
 	ns_db::sql_parameter_list_type params = {
-		feed_name,
+		std::to_string (feed_id),
 		headline
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
-
-	article.feed_name = feed_name;
 	article.headline = headline;
 
-	for (ns_db::sql_row_type row : rows) {
-		for (auto [name, value] : row) {
-			if (name == "article_summary") {
-				article.article_summary = value;
-			} else if (name == "article_text") {
-				article.article_text = value;
-			} else if (name == "article_date") {
-				article.article_date = value;
-			} else if (name == "article_url") {
-				article.url = value;
-			}
-		}
+	ns_db::sql_cursor cursor;
 
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
 		/*Only need first matching row.*/
-		break;
+		if (ns_db::next_row (cursor)) {
+			get_article_body (cursor, 0, article.article_summary);
+			get_article_body (cursor, 1, article.article_text);
+			article.article_date = ns_db::get_column_text (cursor, 2);
+			article.url = ns_db::get_column_text (cursor, 3);
+			article.feed_name = ns_db::get_column_text (cursor, 4);
+			article.article_date_epoch = ns_db::get_column_int64 (cursor, 5);
+		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return;
 }
 
 int64_t
 gautier_rss_data_read::get_feed_headline_count (const std::string db_file_name, const std::string feed_name)
+{
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
+
+	return get_feed_headline_count (db_file_name, feed_id);
+}
+
+int64_t
+gautier_rss_data_read::get_feed_headline_count (const std::string db_file_name, const int64_t feed_id)
 {
 	int64_t size = 0;
 
-	namespace ns_db = gautier_rss_database;
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
+
+	const std::string sql_text =
+	    "SELECT \
+			article_count \
+		FROM feeds \
+		WHERE feed_id = @feed_id";
+
+	ns_db::sql_parameter_list_type params = {
+		std::to_string (feed_id)
+	};
+
+	ns_db::sql_cursor cursor;
+
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		if (ns_db::next_row (cursor)) {
+			size = ns_db::get_column_int64 (cursor, 0);
+		}
+
+		ns_db::close_cursor (cursor);
+	}
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	ns_db::release_reader (db_file_name, db);
+
+	return size;
+}
+
+int64_t
+gautier_rss_data_read::get_feed_id (const std::string db_file_name, const std::string feed_name)
+{
+	int64_t feed_id = -1;
+
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
-			COUNT(*) AS article_count \
-		FROM feeds_articles \
+			feed_id \
+		FROM feeds \
 		WHERE feed_name = @feed_name";
 
 	ns_db::sql_parameter_list_type params = {
 		feed_name
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		for (auto [name, value] : row) {
-			if (name == "article_count") {
-				size = (int64_t) (std::stoll (value));
-			}
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		if (ns_db::next_row (cursor)) {
+			feed_id = ns_db::get_column_int64 (cursor, 0);
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
-	return size;
+	return feed_id;
 }
 
 int64_t
@@ -495,15 +669,11 @@ gautier_rss_data_read::get_row_id (const std::string db_file_name, const std::st
 {
 	int64_t row_id = -1;
 
-	namespace ns_db = gautier_rss_database;
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
-
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
-			rowid \
+			feed_id \
 		FROM feeds \
 		WHERE feed_url = @feed_url";
 
@@ -511,19 +681,17 @@ gautier_rss_data_read::get_row_id (const std::string db_file_name, const std::st
 		feed_url
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		for (auto [name, value] : row) {
-			if (name == "rowid") {
-				row_id = std::stoll (value);
-
-				break;
-			}
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		if (ns_db::next_row (cursor)) {
+			row_id = ns_db::get_column_int64 (cursor, 0);
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return row_id;
 }
@@ -533,12 +701,7 @@ gautier_rss_data_read::get_article_row_id (const std::string db_file_name, const
 {
 	int64_t row_id = -1;
 
-	namespace ns_db = gautier_rss_database;
-
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
-
-	ns_db::sql_rowset_type rows;
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
 	const std::string sql_text =
 	    "SELECT \
@@ -550,19 +713,17 @@ gautier_rss_data_read::get_article_row_id (const std::string db_file_name, const
 		article_url
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
-
-	for (ns_db::sql_row_type row : rows) {
-		for (auto [name, value] : row) {
-			if (name == "rowid") {
-				row_id = std::stoll (value);
+	ns_db::sql_cursor cursor;
 
-				break;
-			}
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		if (ns_db::next_row (cursor)) {
+			row_id = ns_db::get_column_int64 (cursor, 0);
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return row_id;
 }
@@ -570,37 +731,39 @@ gautier_rss_data_read::get_article_row_id (const std::string db_file_name, const
 int64_t
 gautier_rss_data_read::get_feed_article_max_row_id (const std::string db_file_name, const std::string feed_name)
 {
-	int64_t row_id = -1;
+	const int64_t feed_id = get_feed_id (db_file_name, feed_name);
 
-	namespace ns_db = gautier_rss_database;
+	return get_feed_article_max_row_id (db_file_name, feed_id);
+}
+
+int64_t
+gautier_rss_data_read::get_feed_article_max_row_id (const std::string db_file_name, const int64_t feed_id)
+{
+	int64_t row_id = -1;
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
 
-	ns_db::sql_rowset_type rows;
 	const std::string sql_text =
 	    "SELECT \
-			IFNULL(MAX(rowid), -1) AS rowid \
-		FROM feeds_articles \
-		WHERE feed_name = @feed_name";
+			article_max_row_id \
+		FROM feeds \
+		WHERE feed_id = @feed_id";
 
 	ns_db::sql_parameter_list_type params = {
-		feed_name
+		std::to_string (feed_id)
 	};
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	ns_db::sql_cursor cursor;
 
-	for (ns_db::sql_row_type row : rows) {
-		for (auto [name, value] : row) {
-			if (name == "rowid") {
-				row_id = std::stoll (value);
-
-				break;
-			}
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		if (ns_db::next_row (cursor)) {
+			row_id = ns_db::get_column_int64 (cursor, 0);
 		}
+
+		ns_db::close_cursor (cursor);
 	}
 
-	ns_db::close_db (&db);
+	ns_db::release_reader (db_file_name, db);
 
 	return row_id;
 }
@@ -630,3 +793,54 @@ gautier_rss_data_read::headline_range_valid (const headline_range_type& range)
 {
 	return range.first > -1 && range.first < range.second;
 }
+
+void
+gautier_rss_data_read::search_articles (const std::string db_file_name, const std::string search_text,
+                                        const int64_t offset, const int64_t limit, articles_list_type& articles)
+{
+	const std::string search_query = create_search_query (search_text);
+
+	if (search_query.empty()) {
+		return;
+	}
+
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
+
+	/*bm25 column weights: headline_text, article_summary, article_text*/
+	const std::string sql_text =
+	    "SELECT \
+			f.feed_name, fa.headline_text, \
+			b.article_summary, b.article_text, \
+			fa.article_date, fa.article_url, fa.article_date_epoch \
+		FROM feeds_articles_search AS s INNER JOIN \
+			feeds_articles AS fa ON fa.article_id = s.rowid INNER JOIN \
+			feeds AS f ON f.feed_id = fa.feed_id LEFT OUTER JOIN \
+			feeds_articles_body AS b ON b.article_id = fa.article_id \
+		WHERE feeds_articles_search MATCH @search_query \
+		ORDER BY bm25(feeds_articles_search, 10.0, 2.0, 1.0) \
+		LIMIT @limit OFFSET @offset;";
+
+	ns_db::sql_parameter_list_type params = {
+		search_query,
+		std::to_string (limit),
+		std::to_string (offset)
+	};
+
+	ns_db::sql_cursor cursor;
+
+	if (ns_db::open_cursor (&db, sql_text, params, cursor)) {
+		while (ns_db::next_row (cursor)) {
+			rss_article article;
+
+			create_article_from_sql_row (cursor, article);
+
+			articles.emplace_back (std::move (article));
+		}
+
+		ns_db::close_cursor (cursor);
+	}
+
+	ns_db::release_reader (db_file_name, db);
+
+	return;
+}
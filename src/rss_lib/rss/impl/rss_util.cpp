@@ -10,6 +10,7 @@ You should have received a copy of the GNU Lesser General Public License along w
 Author: Michael Gautier <michaelgautier.wordpress.com>
 */
 
+#include <cctype>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
@@ -22,160 +23,1307 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <sstream>
 #include <string>
 
-#include "rss_lib/db/db.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GAUTIER_RSS_AVX2_KERNELS 1
+#endif
+
+#include <zlib.h>
+
 #include "rss_lib/rss/rss_util.hpp"
 
-int_fast32_t
-gautier_rss_util::get_time_difference_in_seconds (const std::string date1, const std::string date2)
-{
-	//See SQLite documentation: SQL As Understood By SQLite - Date And Time Functions
+namespace {
+	/*
+		Days since 1970-01-01 for a date in the proleptic Gregorian calendar.
+		Howard Hinnant, chrono-Compatible Low-Level Date Algorithms.
+	*/
+	int64_t
+	get_days_from_civil (int64_t year, const int64_t month, const int64_t day)
+	{
+		year -= (month <= 2);
+
+		const int64_t era = (year >= 0 ? year : year - 399) / 400;
+		const int64_t year_of_era = year - era * 400;
+		const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+		const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+		return era * 146097 + day_of_era - 719468;
+	}
+
+	void
+	get_civil_from_days (int64_t days, int64_t& year, int64_t& month, int64_t& day)
+	{
+		days += 719468;
+
+		const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+		const int64_t day_of_era = days - era * 146097;
+		const int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+		const int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+		const int64_t month_part = (5 * day_of_year + 2) / 153;
+
+		day = day_of_year - (153 * month_part + 2) / 5 + 1;
+		month = month_part + (month_part < 10 ? 3 : -9);
+		year = year_of_era + era * 400 + (month <= 2);
+
+		return;
+	}
+
+	/*
+		Reads exactly digit_count digits at text[position].
+	*/
+	bool
+	read_digits (std::string_view text, const size_t position, const size_t digit_count, int64_t& value)
+	{
+		if (position + digit_count > text.size()) {
+			return false;
+		}
+
+		value = 0;
+
+		for (size_t i = position; i < position + digit_count; i++) {
+			const char c = text[i];
+
+			if (c < '0' || c > '9') {
+				return false;
+			}
+
+			value = (value * 10) + (c - '0');
+		}
+
+		return true;
+	}
+
+	void
+	write_digits (char* out, int64_t value, const size_t digit_count)
+	{
+		for (size_t i = digit_count; i > 0; i--) {
+			out[i - 1] = (char) ('0' + (value % 10));
+			value /= 10;
+		}
+
+		return;
+	}
+
+	/*
+		PUBLICATION DATES
+
+		Feeds write dates in RFC 822/1123 (RSS), RFC 3339 (Atom) and many near misses.
+		Words are matched by their first 3 letters without regard to case.
+	*/
+	struct time_zone_name
+	{
+		public:
+			std::string_view name;
+			int64_t offset_minutes;
+	};
+
+	constexpr std::string_view
+	month_names[12] = {"jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"};
+
+	constexpr std::string_view
+	weekday_names[7] = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+
+	constexpr time_zone_name
+	time_zone_names[] = {
+		{"z", 0}, {"ut", 0}, {"utc", 0}, {"gmt", 0},
+		{"est", -300}, {"edt", -240}, {"cst", -360}, {"cdt", -300},
+		{"mst", -420}, {"mdt", -360}, {"pst", -480}, {"pdt", -420},
+		{"akst", -540}, {"akdt", -480}, {"hst", -600},
+		{"wet", 0}, {"west", 60}, {"bst", 60}, {"cet", 60}, {"cest", 120},
+		{"eet", 120}, {"eest", 180}, {"msk", 180},
+		{"jst", 540}, {"kst", 540}, {"aest", 600}, {"aedt", 660}, {"nzst", 720}, {"nzdt", 780}
+	};
+
+	bool
+	is_ascii_digit (const char c)
+	{
+		return (c >= '0' && c <= '9');
+	}
+
+	bool
+	is_ascii_alpha (const char c)
+	{
+		return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+	}
+
+	/*
+		1 to 12 for a month name or its 3 letter abbreviation. 0 when not a month.
+	*/
+	int64_t
+	get_month_number (std::string_view word)
+	{
+		if (word.size() < 3) {
+			return 0;
+		}
+
+		for (size_t i = 0; i < 12; i++) {
+			if (gautier_rss_util::equals_ignore_case (word.substr (0, 3), month_names[i])) {
+				return (int64_t) (i + 1);
+			}
+		}
+
+		return 0;
+	}
+
+	bool
+	is_weekday_name (std::string_view word)
+	{
+		if (word.size() < 3) {
+			return false;
+		}
+
+		for (std::string_view weekday_name : weekday_names) {
+			if (gautier_rss_util::equals_ignore_case (word.substr (0, 3), weekday_name)) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool
+	get_time_zone_offset (std::string_view word, int64_t& offset_minutes)
+	{
+		for (const time_zone_name& zone : time_zone_names) {
+			if (gautier_rss_util::equals_ignore_case (word, zone.name)) {
+				offset_minutes = zone.offset_minutes;
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/*
+		Reads 1 or more digits at text[position] and moves position past them.
+	*/
+	size_t
+	read_number (std::string_view text, size_t& position, int64_t& value)
+	{
+		const size_t start = position;
+
+		value = 0;
+
+		while (position < text.size() && is_ascii_digit (text[position]) && position - start < 9) {
+			value = (value * 10) + (text[position] - '0');
+			position++;
+		}
+
+		return (position - start);
+	}
+
+	/*
+		Reads a numeric zone offset after the sign: hh, hhmm or hh:mm.
+	*/
+	bool
+	read_zone_offset (std::string_view text, size_t& position, int64_t& offset_minutes)
+	{
+		const int64_t sign = (text[position] == '-' ? -1 : 1);
+
+		position++;
+
+		int64_t value = 0;
+
+		const size_t digit_count = read_number (text, position, value);
+
+		int64_t hours = 0;
+		int64_t minutes = 0;
+
+		if (digit_count == 4) {
+			hours = value / 100;
+			minutes = value % 100;
+		} else if (digit_count == 1 || digit_count == 2) {
+			hours = value;
+
+			if (position < text.size() && text[position] == ':') {
+				position++;
+
+				if (read_number (text, position, minutes) != 2) {
+					return false;
+				}
+			}
+		} else {
+			return false;
+		}
+
+		if (hours > 14 || minutes > 59) {
+			return false;
+		}
+
+		offset_minutes = sign * ((hours * 60) + minutes);
+
+		return true;
+	}
+
+	/*
+		Reads H:MM, HH:MM, HH:MM:SS and HH:MM:SS.fraction starting at the hour.
+	*/
+	bool
+	read_time_of_day (std::string_view text, size_t& position, int64_t& seconds_of_day)
+	{
+		int64_t hour = 0;
+		int64_t minute = 0;
+		int64_t second = 0;
+
+		const size_t hour_digits = read_number (text, position, hour);
+
+		if (hour_digits < 1 || hour_digits > 2 || position >= text.size() || text[position] != ':') {
+			return false;
+		}
+
+		position++;
+
+		if (read_number (text, position, minute) != 2) {
+			return false;
+		}
+
+		if (position < text.size() && text[position] == ':') {
+			position++;
+
+			if (read_number (text, position, second) != 2) {
+				return false;
+			}
+
+			if (position < text.size() && (text[position] == '.' || text[position] == ',')) {
+				position++;
+
+				while (position < text.size() && is_ascii_digit (text[position])) {
+					position++;
+				}
+			}
+		}
+
+		/*A leap second is counted as the last second of the minute.*/
+		if (hour > 24 || minute > 59 || second > 60 || (hour == 24 && (minute > 0 || second > 0))) {
+			return false;
+		}
+
+		seconds_of_day = (hour * 3600) + (minute * 60) + std::min<int64_t> (second, 59);
+
+		return true;
+	}
+
+	int64_t
+	get_days_in_month (const int64_t year, const int64_t month)
+	{
+		constexpr int64_t days_in_month[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+		const bool leap_year = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+
+		return (month == 2 && leap_year) ? 29 : days_in_month[month - 1];
+	}
+
+	/*
+		YYYY-MM-DD, then optional T or space and a time, then optional Z, numeric offset or zone name.
+		A / in place of - is accepted.
+	*/
+	bool
+	parse_iso_date_time (std::string_view text, int64_t& year, int64_t& month, int64_t& day,
+	                     int64_t& seconds_of_day, int64_t& offset_minutes)
+	{
+		size_t position = 0;
+
+		const char separator = text[4];
+
+		if (read_number (text, position, year) != 4 || text[position] != separator) {
+			return false;
+		}
+
+		position++;
+
+		const size_t month_digits = read_number (text, position, month);
+
+		if (month_digits < 1 || month_digits > 2 || position >= text.size() || text[position] != separator) {
+			return false;
+		}
+
+		position++;
+
+		const size_t day_digits = read_number (text, position, day);
+
+		if (day_digits < 1 || day_digits > 2) {
+			return false;
+		}
+
+		if (position < text.size() && (text[position] == 'T' || text[position] == 't' || text[position] == ' ')) {
+			position++;
+
+			while (position < text.size() && text[position] == ' ') {
+				position++;
+			}
+
+			if (position < text.size() && is_ascii_digit (text[position]) &&
+			        read_time_of_day (text, position, seconds_of_day) == false) {
+				return false;
+			}
+		}
+
+		while (position < text.size() && text[position] == ' ') {
+			position++;
+		}
+
+		if (position < text.size()) {
+			const char c = text[position];
+
+			if (c == '+' || c == '-') {
+				if (read_zone_offset (text, position, offset_minutes) == false) {
+					return false;
+				}
+			} else if (is_ascii_alpha (c)) {
+				const size_t start = position;
+
+				while (position < text.size() && is_ascii_alpha (text[position])) {
+					position++;
+				}
+
+				get_time_zone_offset (text.substr (start, position - start), offset_minutes);
+			}
+		}
+
+		while (position < text.size() && text[position] == ' ') {
+			position++;
+		}
+
+		return (position == text.size());
+	}
+
+	/*
+		Takes the date apart word by word so the parts may come in any usual order:
+			Tue, 10 Jun 2003 04:00:00 GMT	(RFC 822/1123)
+			Tuesday, 10-Jun-03 04:00:00 EDT	(RFC 850)
+			Tue Jun 10 04:00:00 2003	(asctime)
+			June 10, 2003 4:00 PM +0200
+		A 2 digit year before 50 is in the 2000s.
+	*/
+	bool
+	parse_rfc822_date_time (std::string_view text, int64_t& year, int64_t& month, int64_t& day,
+	                        int64_t& seconds_of_day, int64_t& offset_minutes)
+	{
+		bool time_found = false;
+
+		size_t position = 0;
+
+		while (position < text.size()) {
+			const char c = text[position];
+
+			if (c == ' ' || c == ',' || c == '.' || c == '\t' || (c == '-' && time_found == false) || c == '/') {
+				position++;
+			} else if (c == '(') {
+				/*RFC 822 comment.*/
+				while (position < text.size() && text[position] != ')') {
+					position++;
+				}
+
+				position++;
+			} else if (is_ascii_alpha (c)) {
+				const size_t start = position;
+
+				while (position < text.size() && is_ascii_alpha (text[position])) {
+					position++;
+				}
+
+				const std::string_view word = text.substr (start, position - start);
+
+				const int64_t month_number = get_month_number (word);
+
+				if (month == 0 && month_number > 0) {
+					month = month_number;
+				} else if (time_found && gautier_rss_util::equals_ignore_case (word, "pm")) {
+					if (seconds_of_day < 12 * 3600) {
+						seconds_of_day += 12 * 3600;
+					}
+				} else if (time_found && gautier_rss_util::equals_ignore_case (word, "am")) {
+					if (seconds_of_day >= 12 * 3600) {
+						seconds_of_day -= 12 * 3600;
+					}
+				} else if (is_weekday_name (word) == false) {
+					/*Unknown zone names are taken as UTC.*/
+					get_time_zone_offset (word, offset_minutes);
+				}
+			} else if ((c == '+' || c == '-') && time_found) {
+				if (read_zone_offset (text, position, offset_minutes) == false) {
+					return false;
+				}
+			} else if (is_ascii_digit (c)) {
+				size_t number_end = position;
+
+				int64_t value = 0;
+
+				const size_t digit_count = read_number (text, number_end, value);
+
+				if (number_end < text.size() && text[number_end] == ':') {
+					if (time_found || read_time_of_day (text, position, seconds_of_day) == false) {
+						return false;
+					}
+
+					time_found = true;
+				} else {
+					position = number_end;
+
+					if (digit_count == 4 && year == 0) {
+						year = value;
+					} else if (digit_count <= 2 && day == 0) {
+						day = value;
+					} else if (digit_count <= 3 && year == 0) {
+						year = (value < 50 ? 2000 + value : 1900 + value);
+					} else {
+						return false;
+					}
+				}
+			} else {
+				return false;
+			}
+		}
+
+		return (year > 0);
+	}
+
+	/*
+		The text of get_current_date_time_utc for the current second, per thread.
+	*/
+	thread_local int64_t
+	cached_date_time_epoch_seconds = -1;
+
+	thread_local std::string
+	cached_date_time_utc;
+}
+
+/*
+	Parses the date/time text SQLite produces and understands:
+		YYYY-MM-DD
+		YYYY-MM-DD HH:MM
+		YYYY-MM-DD HH:MM:SS
+		YYYY-MM-DD HH:MM:SS.SSS
+	A T may separate the date and time. Fractional seconds and a trailing Z are ignored.
+	The value is taken as UTC.
+*/
+bool
+gautier_rss_util::parse_date_time (std::string_view text, int64_t& epoch_seconds)
+{
+	int64_t year = 0;
+	int64_t month = 0;
+	int64_t day = 0;
+	int64_t hour = 0;
+	int64_t minute = 0;
+	int64_t second = 0;
+
+	const bool date_good = read_digits (text, 0, 4, year) && text.size() >= 10 && text[4] == '-' &&
+	                       read_digits (text, 5, 2, month) && text[7] == '-' && read_digits (text, 8, 2, day);
+
+	if (date_good == false || month < 1 || month > 12 || day < 1 || day > 31) {
+		return false;
+	}
+
+	if (text.size() > 10) {
+		const bool time_good = (text[10] == ' ' || text[10] == 'T') && read_digits (text, 11, 2, hour) &&
+		                       text.size() >= 16 && text[13] == ':' && read_digits (text, 14, 2, minute);
+
+		if (time_good == false || hour > 23 || minute > 59) {
+			return false;
+		}
+
+		if (text.size() > 16) {
+			const bool seconds_good = text[16] == ':' && read_digits (text, 17, 2, second) && second < 60;
+
+			if (seconds_good == false) {
+				return false;
+			}
+
+			if (text.size() > 19 && text[19] != '.' && text[19] != 'Z') {
+				return false;
+			}
+		}
+	}
+
+	epoch_seconds = (get_days_from_civil (year, month, day) * 86400) + (hour * 3600) + (minute * 60) + second;
+
+	return true;
+}
+
+/*
+	Writes YYYY-MM-DD HH:MM:SS (UTC).
+*/
+void
+gautier_rss_util::format_date_time (const int64_t epoch_seconds, std::string& text)
+{
+	int64_t days = epoch_seconds / 86400;
+	int64_t seconds_of_day = epoch_seconds % 86400;
+
+	if (seconds_of_day < 0) {
+		days--;
+		seconds_of_day += 86400;
+	}
+
+	int64_t year = 0;
+	int64_t month = 0;
+	int64_t day = 0;
+
+	get_civil_from_days (days, year, month, day);
+
+	char out[19] = {'0', '0', '0', '0', '-', '0', '0', '-', '0', '0', ' ', '0', '0', ':', '0', '0', ':', '0', '0'};
+
+	write_digits (out, year, 4);
+	write_digits (out + 5, month, 2);
+	write_digits (out + 8, day, 2);
+	write_digits (out + 11, seconds_of_day / 3600, 2);
+	write_digits (out + 14, (seconds_of_day / 60) % 60, 2);
+	write_digits (out + 17, seconds_of_day % 60, 2);
+
+	text.assign (out, sizeof (out));
+
+	return;
+}
+
+/*
+	Reads the publication date of a feed entry into epoch seconds (UTC).
+	Returns false when the text is not a recognizable date.
+
+	Works on the text in place. Nothing is allocated.
+*/
+bool
+gautier_rss_util::parse_publication_date (std::string_view text, int64_t& epoch_seconds)
+{
+	text = trim_white_space (text);
+
+	int64_t year = 0;
+	int64_t month = 0;
+	int64_t day = 0;
+	int64_t seconds_of_day = 0;
+	int64_t offset_minutes = 0;
+
+	bool parsed = false;
+
+	const bool iso_format = (text.size() >= 8 && is_ascii_digit (text[0]) && is_ascii_digit (text[1]) &&
+	                         is_ascii_digit (text[2]) && is_ascii_digit (text[3]) && (text[4] == '-' || text[4] == '/'));
+
+	if (iso_format) {
+		parsed = parse_iso_date_time (text, year, month, day, seconds_of_day, offset_minutes);
+	} else {
+		parsed = parse_rfc822_date_time (text, year, month, day, seconds_of_day, offset_minutes);
+	}
+
+	if (parsed == false || month < 1 || month > 12 || day < 1 || day > get_days_in_month (year, month)) {
+		return false;
+	}
+
+	epoch_seconds = (get_days_from_civil (year, month, day) * 86400) + seconds_of_day - (offset_minutes * 60);
+
+	return true;
+}
+
+int64_t
+gautier_rss_util::get_current_epoch_seconds()
+{
+	return (int64_t)std::time (nullptr);
+}
+
+/*
+	Seconds between two date/time values, in either order.
+	An empty value means the current time. Returns 0 when a value cannot be read.
+*/
+int_fast32_t
+gautier_rss_util::get_time_difference_in_seconds (const std::string date1, const std::string date2)
+{
+	const int64_t now = get_current_epoch_seconds();
+
+	int64_t epoch_seconds1 = now;
+	int64_t epoch_seconds2 = now;
+
+	if (date1.empty() == false && parse_date_time (date1, epoch_seconds1) == false) {
+		return 0;
+	}
+
+	if (date2.empty() == false && parse_date_time (date2, epoch_seconds2) == false) {
+		return 0;
+	}
+
+	return (int_fast32_t)std::llabs (epoch_seconds1 - epoch_seconds2);
+}
+
+/*
+	Gets the current date and time.
+	Provides the date/time in a format understood by many
+	systems such as SQLite.
+
+	The text is formatted at most once per second on each thread.
+*/
+std::string
+gautier_rss_util::get_current_date_time_utc()
+{
+	const int64_t now = get_current_epoch_seconds();
+
+	if (now != cached_date_time_epoch_seconds) {
+		format_date_time (now, cached_date_time_utc);
+
+		cached_date_time_epoch_seconds = now;
+	}
+
+	return cached_date_time_utc;
+}
+
+std::string
+gautier_rss_util::get_current_date_time_local()
+{
+	/*
+		Gets the current date and time.
+		Provides the date/time in a format understood by many
+		systems such as SQLite as the local time.
+	*/
+	std::string datetime;
+	{
+		std::time_t result = std::time (nullptr);
+
+		std::stringstream strout;
+
+		/* MinGW Windows Cross Compile does not understand the short-hand: %F %T */
+		strout << std::put_time (std::localtime (&result), "%Y-%m-%d %H:%M:%S");
+
+		datetime = strout.str();
+	}
+
+	return datetime;
+}
+
+
+/*
+	TEXT KERNELS
+
+	ASCII lower case, digit filtering, white space trimming and case insensitive compare.
+	x86 builds process 32 bytes (AVX2, chosen at run time) or 16 bytes (SSE2) per step and
+	finish the remainder one char at a time. Other targets use the char at a time loop only.
+
+	Bytes outside of ASCII are passed through unchanged, the same as std::tolower in the "C" locale.
+	White space is the std::isspace set: space, \t, \n, \v, \f and \r.
+*/
+namespace {
+	char
+	to_lower_ascii (const char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c;
+	}
+
+	bool
+	is_white_space_ascii (const char c)
+	{
+		return (c == ' ' || (c >= '\t' && c <= '\r'));
+	}
+
+#if defined(__SSE2__)
+	__m128i
+	to_lower_sse2 (const __m128i chars)
+	{
+		const __m128i is_upper = _mm_and_si128 (_mm_cmpgt_epi8 (chars, _mm_set1_epi8 ('A' - 1)),
+		                                        _mm_cmplt_epi8 (chars, _mm_set1_epi8 ('Z' + 1)));
+
+		return _mm_or_si128 (chars, _mm_and_si128 (is_upper, _mm_set1_epi8 (0x20)));
+	}
+
+	/*Bit per char: set for '0' to '9'.*/
+	uint32_t
+	get_digit_mask_sse2 (const __m128i chars)
+	{
+		const __m128i is_digit = _mm_and_si128 (_mm_cmpgt_epi8 (chars, _mm_set1_epi8 ('0' - 1)),
+		                                        _mm_cmplt_epi8 (chars, _mm_set1_epi8 ('9' + 1)));
+
+		return (uint32_t) (_mm_movemask_epi8 (is_digit));
+	}
+
+	/*Bit per char: set for white space.*/
+	uint32_t
+	get_white_space_mask_sse2 (const __m128i chars)
+	{
+		const __m128i is_control_space = _mm_and_si128 (_mm_cmpgt_epi8 (chars, _mm_set1_epi8 ('\t' - 1)),
+		                                 _mm_cmplt_epi8 (chars, _mm_set1_epi8 ('\r' + 1)));
+
+		const __m128i is_space = _mm_or_si128 (is_control_space, _mm_cmpeq_epi8 (chars, _mm_set1_epi8 (' ')));
+
+		return (uint32_t) (_mm_movemask_epi8 (is_space));
+	}
+#endif
 
-	const std::string db_file_name = ":memory:";
-	int_fast32_t seconds = 0;
+#if defined(GAUTIER_RSS_AVX2_KERNELS)
+	bool
+	get_cpu_has_avx2()
+	{
+		__builtin_cpu_init();
+
+		return __builtin_cpu_supports ("avx2");
+	}
 
-	namespace ns_db = gautier_rss_database;
+	const bool
+	cpu_has_avx2 = get_cpu_has_avx2();
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	__attribute__ ((target ("avx2"))) __m256i
+	to_lower_avx2 (const __m256i chars)
+	{
+		const __m256i is_upper = _mm256_and_si256 (_mm256_cmpgt_epi8 (chars, _mm256_set1_epi8 ('A' - 1)),
+		                         _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('Z' + 1), chars));
 
-	ns_db::sql_rowset_type rows;
-	const std::string sql_text = "SELECT ABS(STRFTIME('%s', @date1) - strftime('%s', @date2)) AS result;";
+		return _mm256_or_si256 (chars, _mm256_and_si256 (is_upper, _mm256_set1_epi8 (0x20)));
+	}
 
-	std::string datetime1 = date1;
-	std::string datetime2 = date2;
+	__attribute__ ((target ("avx2"))) uint32_t
+	get_digit_mask_avx2 (const __m256i chars)
+	{
+		const __m256i is_digit = _mm256_and_si256 (_mm256_cmpgt_epi8 (chars, _mm256_set1_epi8 ('0' - 1)),
+		                         _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('9' + 1), chars));
 
-	if (date1.empty()) {
-		datetime1 = get_current_date_time_utc();
+		return (uint32_t) (_mm256_movemask_epi8 (is_digit));
 	}
 
-	if (date2.empty()) {
-		datetime2 = get_current_date_time_utc();
+	__attribute__ ((target ("avx2"))) uint32_t
+	get_white_space_mask_avx2 (const __m256i chars)
+	{
+		const __m256i is_control_space = _mm256_and_si256 (_mm256_cmpgt_epi8 (chars, _mm256_set1_epi8 ('\t' - 1)),
+		                                 _mm256_cmpgt_epi8 (_mm256_set1_epi8 ('\r' + 1), chars));
+
+		const __m256i is_space = _mm256_or_si256 (is_control_space, _mm256_cmpeq_epi8 (chars, _mm256_set1_epi8 (' ')));
+
+		return (uint32_t) (_mm256_movemask_epi8 (is_space));
 	}
 
-	ns_db::sql_parameter_list_type params = {
-		datetime1,
-		datetime2
-	};
+	__attribute__ ((target ("avx2"))) void
+	lower_case_avx2 (const char* text, const size_t char_count, size_t& char_index, char* output)
+	{
+		for (; char_index + 32 <= char_count; char_index += 32) {
+			const __m256i chars = _mm256_loadu_si256 ((const __m256i*) (text + char_index));
+
+			_mm256_storeu_si256 ((__m256i*) (output + char_index), to_lower_avx2 (chars));
+		}
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+		return;
+	}
 
-	for (ns_db::sql_row_type row : rows) {
-		for (auto [name, value] : row) {
-			if (name == "result") {
-				std::string result = value;
+	__attribute__ ((target ("avx2"))) void
+	copy_digits_avx2 (const char* text, const size_t char_count, size_t& char_index, char* output,
+	                  size_t& output_index)
+	{
+		for (; char_index + 32 <= char_count; char_index += 32) {
+			const __m256i chars = _mm256_loadu_si256 ((const __m256i*) (text + char_index));
 
-				if (result.empty() == false) {
-					seconds = std::stoi (result);
-				}
+			uint32_t digit_mask = get_digit_mask_avx2 (chars);
+
+			if (digit_mask == 0xffffffffu) {
+				_mm256_storeu_si256 ((__m256i*) (output + output_index), chars);
+				output_index += 32;
+				continue;
+			}
+
+			while (digit_mask != 0) {
+				output[output_index++] = text[char_index + (size_t) (__builtin_ctz (digit_mask))];
+				digit_mask &= digit_mask - 1;
 			}
 		}
+
+		return;
 	}
 
-	ns_db::close_db (&db);
+	__attribute__ ((target ("avx2"))) bool
+	skip_leading_white_space_avx2 (const char* text, const size_t char_count, size_t& char_index)
+	{
+		for (; char_index + 32 <= char_count; char_index += 32) {
+			const __m256i chars = _mm256_loadu_si256 ((const __m256i*) (text + char_index));
 
-	return seconds;
-}
+			const uint32_t text_mask = ~get_white_space_mask_avx2 (chars);
 
-std::string
-gautier_rss_util::get_current_date_time_utc()
-{
-	/*
-		Gets the current date and time.
-		Provides the date/time in a format understood by many
-		systems such as SQLite.
-	*/
-	std::string datetime;
+			if (text_mask != 0) {
+				char_index += (size_t) (__builtin_ctz (text_mask));
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	__attribute__ ((target ("avx2"))) bool
+	skip_trailing_white_space_avx2 (const char* text, const size_t start_index, size_t& end_index)
 	{
-		std::time_t result = std::time (nullptr);
+		for (; end_index >= start_index + 32; end_index -= 32) {
+			const __m256i chars = _mm256_loadu_si256 ((const __m256i*) (text + end_index - 32));
 
-		std::stringstream strout;
+			const uint32_t text_mask = ~get_white_space_mask_avx2 (chars);
 
-		/* MinGW Windows Cross Compile does not understand the short-hand: %F %T */
-		strout << std::put_time (std::gmtime (&result), "%Y-%m-%d %H:%M:%S");
+			if (text_mask != 0) {
+				end_index -= (size_t) (__builtin_clz (text_mask));
 
-		datetime = strout.str();
+				return true;
+			}
+		}
+
+		return false;
 	}
 
-	return datetime;
+	__attribute__ ((target ("avx2"))) bool
+	equals_ignore_case_avx2 (const char* text1, const char* text2, const size_t char_count, size_t& char_index)
+	{
+		for (; char_index + 32 <= char_count; char_index += 32) {
+			const __m256i chars1 = to_lower_avx2 (_mm256_loadu_si256 ((const __m256i*) (text1 + char_index)));
+			const __m256i chars2 = to_lower_avx2 (_mm256_loadu_si256 ((const __m256i*) (text2 + char_index)));
+
+			if ((uint32_t) (_mm256_movemask_epi8 (_mm256_cmpeq_epi8 (chars1, chars2))) != 0xffffffffu) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+#endif
+
+	void
+	lower_case_kernel (const char* text, const size_t char_count, char* output)
+	{
+		size_t char_index = 0;
+
+#if defined(GAUTIER_RSS_AVX2_KERNELS)
+
+		if (cpu_has_avx2) {
+			lower_case_avx2 (text, char_count, char_index, output);
+		}
+
+#endif
+#if defined(__SSE2__)
+
+		for (; char_index + 16 <= char_count; char_index += 16) {
+			const __m128i chars = _mm_loadu_si128 ((const __m128i*) (text + char_index));
+
+			_mm_storeu_si128 ((__m128i*) (output + char_index), to_lower_sse2 (chars));
+		}
+
+#endif
+
+		for (; char_index < char_count; char_index++) {
+			output[char_index] = to_lower_ascii (text[char_index]);
+		}
+
+		return;
+	}
+
+	/*Returns the number of digits written to output.*/
+	size_t
+	copy_digits_kernel (const char* text, const size_t char_count, char* output)
+	{
+		size_t char_index = 0;
+		size_t output_index = 0;
+
+#if defined(GAUTIER_RSS_AVX2_KERNELS)
+
+		if (cpu_has_avx2) {
+			copy_digits_avx2 (text, char_count, char_index, output, output_index);
+		}
+
+#endif
+#if defined(__SSE2__)
+
+		for (; char_index + 16 <= char_count; char_index += 16) {
+			const __m128i chars = _mm_loadu_si128 ((const __m128i*) (text + char_index));
+
+			uint32_t digit_mask = get_digit_mask_sse2 (chars);
+
+			if (digit_mask == 0xffffu) {
+				_mm_storeu_si128 ((__m128i*) (output + output_index), chars);
+				output_index += 16;
+				continue;
+			}
+
+			while (digit_mask != 0) {
+				output[output_index++] = text[char_index + (size_t) (__builtin_ctz (digit_mask))];
+				digit_mask &= digit_mask - 1;
+			}
+		}
+
+#endif
+
+		for (; char_index < char_count; char_index++) {
+			const char character = text[char_index];
+
+			if (character >= '0' && character <= '9') {
+				output[output_index++] = character;
+			}
+		}
+
+		return output_index;
+	}
 }
 
-std::string
-gautier_rss_util::get_current_date_time_local()
+/*
+	LOWER CASE
+
+	Replaces the content of lower_case_text. Reusing the same output string across calls avoids allocation.
+*/
+void
+gautier_rss_util::convert_to_lower_case (std::string_view text, std::string& lower_case_text)
 {
-	/*
-		Gets the current date and time.
-		Provides the date/time in a format understood by many
-		systems such as SQLite as the local time.
-	*/
-	std::string datetime;
-	{
-		std::time_t result = std::time (nullptr);
+	lower_case_text.resize (text.size());
 
-		std::stringstream strout;
+	lower_case_kernel (text.data(), text.size(), lower_case_text.data());
 
-		/* MinGW Windows Cross Compile does not understand the short-hand: %F %T */
-		strout << std::put_time (std::localtime (&result), "%Y-%m-%d %H:%M:%S");
+	return;
+}
 
-		datetime = strout.str();
+/*
+	DIGITS
+
+	Replaces the content of digits with the characters '0' to '9' found in text.
+*/
+void
+gautier_rss_util::copy_digits (std::string_view text, std::string& digits)
+{
+	digits.resize (text.size());
+	digits.resize (copy_digits_kernel (text.data(), text.size(), digits.data()));
+
+	return;
+}
+
+/*
+	TRIM
+
+	The part of text between leading and trailing white space.
+*/
+std::string_view
+gautier_rss_util::trim_white_space (std::string_view text)
+{
+	const char* chars = text.data();
+
+	size_t start_index = 0;
+	size_t end_index = text.size();
+
+	bool start_found = false;
+
+#if defined(GAUTIER_RSS_AVX2_KERNELS)
+
+	if (cpu_has_avx2) {
+		start_found = skip_leading_white_space_avx2 (chars, end_index, start_index);
 	}
 
-	return datetime;
+#endif
+#if defined(__SSE2__)
+
+	for (; start_found == false && start_index + 16 <= end_index; start_index += 16) {
+		const uint32_t text_mask = ~get_white_space_mask_sse2 (_mm_loadu_si128 ((const __m128i*) (chars + start_index))) & 0xffffu;
+
+		if (text_mask != 0) {
+			start_index += (size_t) (__builtin_ctz (text_mask));
+			start_found = true;
+			break;
+		}
+	}
+
+#endif
+
+	while (start_found == false && start_index < end_index) {
+		if (is_white_space_ascii (chars[start_index]) == false) {
+			start_found = true;
+		} else {
+			start_index++;
+		}
+	}
+
+	if (start_found == false) {
+		return text.substr (end_index);
+	}
+
+	/*chars[start_index] is not white space so the backward scan stops at or before it.*/
+	bool end_found = false;
+
+#if defined(GAUTIER_RSS_AVX2_KERNELS)
+
+	if (cpu_has_avx2) {
+		end_found = skip_trailing_white_space_avx2 (chars, start_index, end_index);
+	}
+
+#endif
+#if defined(__SSE2__)
+
+	for (; end_found == false && end_index >= start_index + 16; end_index -= 16) {
+		const uint32_t text_mask = ~get_white_space_mask_sse2 (_mm_loadu_si128 ((const __m128i*) (chars + end_index - 16))) & 0xffffu;
+
+		if (text_mask != 0) {
+			end_index -= (size_t) (__builtin_clz (text_mask) - 16);
+			end_found = true;
+			break;
+		}
+	}
+
+#endif
+
+	while (end_found == false && is_white_space_ascii (chars[end_index - 1])) {
+		end_index--;
+	}
+
+	return text.substr (start_index, end_index - start_index);
 }
 
+/*
+	CASE INSENSITIVE COMPARE
+
+	True when both are the same length and differ only in the case of ASCII letters.
+*/
+bool
+gautier_rss_util::equals_ignore_case (std::string_view text1, std::string_view text2)
+{
+	const size_t char_count = text1.size();
+
+	if (char_count != text2.size()) {
+		return false;
+	}
+
+	size_t char_index = 0;
+
+#if defined(GAUTIER_RSS_AVX2_KERNELS)
+
+	if (cpu_has_avx2 && equals_ignore_case_avx2 (text1.data(), text2.data(), char_count, char_index) == false) {
+		return false;
+	}
+
+#endif
+#if defined(__SSE2__)
+
+	for (; char_index + 16 <= char_count; char_index += 16) {
+		const __m128i chars1 = to_lower_sse2 (_mm_loadu_si128 ((const __m128i*) (text1.data() + char_index)));
+		const __m128i chars2 = to_lower_sse2 (_mm_loadu_si128 ((const __m128i*) (text2.data() + char_index)));
+
+		if ((uint32_t) (_mm_movemask_epi8 (_mm_cmpeq_epi8 (chars1, chars2))) != 0xffffu) {
+			return false;
+		}
+	}
+
+#endif
+
+	for (; char_index < char_count; char_index++) {
+		if (to_lower_ascii (text1[char_index]) != to_lower_ascii (text2[char_index])) {
+			return false;
+		}
+	}
+
+	return true;
+}
 
 /*
 	LOWER CASE all characters.
 
 	Expects a null terminated string.
 
-	Converts all characters to lower case.
+	Appends the characters, converted to lower case, to str.
 */
 void
 gautier_rss_util::convert_chars_to_lower_case_string (const char* chars, std::string& str)
 {
-	const std::string detail = chars;
-	const size_t char_count = detail.size();
+	const size_t char_count = std::strlen (chars);
+	const size_t str_size = str.size();
+
+	str.resize (str_size + char_count);
+
+	lower_case_kernel (chars, char_count, str.data() + str_size);
+
+	return;
+}
+
+/*
+	PLAIN TEXT
+
+	Copies text without HTML/XML tags and character references.
+	Each one removed becomes a single space so words on either side stay apart.
+	The full text search index is built from this so markup is not indexed as words.
+*/
+void
+gautier_rss_util::convert_markup_to_plain_text (std::string_view text, std::string& plain_text)
+{
+	const size_t char_count = text.size();
+
+	plain_text.reserve (plain_text.size() + char_count);
+
+	size_t char_index = 0;
 
-	for (size_t char_index = 0; char_index < char_count; char_index++) {
-		const char character = detail.at (char_index);
+	while (char_index < char_count) {
+		const char character = text[char_index];
 
-		str.push_back ((char) (std::tolower (character)));
+		size_t skip_to = std::string_view::npos;
+
+		if (character == '<') {
+			skip_to = text.find ('>', char_index);
+		} else if (character == '&') {
+			/*&amp; &#8217; &nbsp; ... are short. A longer run is not a reference.*/
+			const size_t reference_end = text.find (';', char_index);
+
+			if (reference_end != std::string_view::npos && reference_end - char_index <= 10) {
+				skip_to = reference_end;
+			}
+		}
+
+		if (skip_to != std::string_view::npos) {
+			plain_text.push_back (' ');
+			char_index = skip_to + 1;
+		} else {
+			plain_text.push_back (character);
+			char_index++;
+		}
 	}
 
 	return;
 }
 
 /*
-	Chars to Numeric
+	TEXT COMPRESSION
+
+	Compressed form:	4 byte little endian length of the original text
+				followed by a zlib stream.
+
+	compress_text returns false, and leaves compressed empty, when compression does not save space.
 */
 bool
-gautier_rss_util::convert_chars_to_string (const char* chars, std::string& str)
+gautier_rss_util::compress_text (std::string_view text, std::string& compressed)
 {
-	const std::string detail = chars;
-	const size_t char_count = detail.size();
+	const size_t header_size = 4;
+	const size_t text_size = text.size();
 
-	for (size_t char_index = 0; char_index < char_count; char_index++) {
-		const char character = detail.at (char_index);
+	compressed.clear();
 
-		str.push_back ((char) (character));
+	if (text_size == 0 || text_size > UINT32_MAX) {
+		return false;
 	}
 
-	return (str.empty() == false);
+	uLongf stream_size = compressBound ((uLong) (text_size));
+
+	compressed.resize (header_size + stream_size);
+
+	for (size_t byte_index = 0; byte_index < header_size; byte_index++) {
+		compressed[byte_index] = (char) ((text_size >> (byte_index * 8)) & 0xff);
+	}
+
+	const int zlib_result = compress2 ((Bytef*) (compressed.data() + header_size), &stream_size,
+	                                   (const Bytef*) (text.data()), (uLong) (text_size), Z_DEFAULT_COMPRESSION);
+
+	if (zlib_result != Z_OK || header_size + stream_size >= text_size) {
+		compressed.clear();
+
+		return false;
+	}
+
+	compressed.resize (header_size + stream_size);
+
+	return true;
 }
 
 bool
-gautier_rss_util::convert_chars_to_int_string (const char* chars, std::string& str)
+gautier_rss_util::decompress_text (std::string_view compressed, std::string& text)
 {
-	const std::string detail = chars;
-	const size_t char_count = detail.size();
+	const size_t header_size = 4;
+
+	text.clear();
+
+	if (compressed.size() <= header_size) {
+		return false;
+	}
+
+	size_t text_size = 0;
+
+	for (size_t byte_index = 0; byte_index < header_size; byte_index++) {
+		text_size |= ((size_t) ((unsigned char) (compressed[byte_index]))) << (byte_index * 8);
+	}
+
+	text.resize (text_size);
+
+	uLongf output_size = (uLongf) (text_size);
+
+	const int zlib_result = uncompress ((Bytef*) (text.data()), &output_size,
+	                                    (const Bytef*) (compressed.data() + header_size), (uLong) (compressed.size() - header_size));
+
+	if (zlib_result != Z_OK || output_size != text_size) {
+		std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") zlib Result: " << zlib_result << "\n\n";
+
+		text.clear();
+
+		return false;
+	}
+
+	return true;
+}
+
+/*
+	ARTICLE FINGERPRINT
+
+	64-bit FNV-1a hash of feed key, headline and url that identifies an article.
+	The feed key is the feed_id as decimal text.
+
+	Feed key and headline are trimmed, lower cased and have runs of white space
+	reduced to a single space before hashing so that cosmetic differences between
+	downloads of the same article produce the same value.
+*/
+namespace {
+	constexpr uint64_t fnv_offset_basis = 14695981039346656037ULL;
+	constexpr uint64_t fnv_prime = 1099511628211ULL;
+
+	void
+	add_to_fingerprint (const std::string& text, const bool normalize, uint64_t& hash)
+	{
+		bool pending_space = false;
+		bool has_chars = false;
+
+		for (const char character : text) {
+			unsigned char ch = (unsigned char) (character);
+
+			if (std::isspace (ch)) {
+				pending_space = has_chars;
+				continue;
+			}
+
+			if (pending_space) {
+				hash = (hash ^ (uint64_t) (' ')) * fnv_prime;
+				pending_space = false;
+			}
 
-	for (size_t char_index = 0; char_index < char_count; char_index++) {
-		const char character = detail.at (char_index);
+			if (normalize) {
+				ch = (unsigned char) (std::tolower (ch));
+			}
 
-		if (std::isdigit (character)) {
-			str.push_back ((char) (character));
+			hash = (hash ^ (uint64_t) (ch)) * fnv_prime;
+			has_chars = true;
 		}
+
+		/* Field separator so that "ab" + "c" differs from "a" + "bc". */
+		hash = (hash ^ (uint64_t) (0x1f)) * fnv_prime;
+
+		return;
 	}
+}
+
+int64_t
+gautier_rss_util::get_article_fingerprint (const std::string& feed_key, const std::string& headline,
+        const std::string& article_url)
+{
+	uint64_t hash = fnv_offset_basis;
+
+	add_to_fingerprint (feed_key, true, hash);
+	add_to_fingerprint (headline, true, hash);
+	add_to_fingerprint (article_url, false, hash);
+
+	return (int64_t) (hash);
+}
+
+/*
+	Chars to Numeric
+*/
+bool
+gautier_rss_util::convert_chars_to_string (const char* chars, std::string& str)
+{
+	str.append (chars);
+
+	return (str.empty() == false);
+}
+
+bool
+gautier_rss_util::convert_chars_to_int_string (const char* chars, std::string& str)
+{
+	const size_t char_count = std::strlen (chars);
+	const size_t str_size = str.size();
+
+	str.resize (str_size + char_count);
+	str.resize (str_size + copy_digits_kernel (chars, char_count, str.data() + str_size));
 
 	return (str.empty() == false);
 }
@@ -17,8 +17,13 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <ctime>
 #include <cuchar>
 #include <cwchar>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <future>
 #include <map>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
@@ -35,46 +40,1163 @@ namespace ns_db = gautier_rss_database;
 namespace ns_parse = gautier_rss_data_parse;
 
 namespace {
+	/*
+		Article summary and text at least this long are stored compressed when that saves space.
+	*/
+	std::atomic_bool
+	article_compression_enabled = true;
+
+	const size_t
+	article_compression_min_size = 512;
+
+	/*
+		Free pages returned to the file system per maintenance slice.
+	*/
+	const int64_t
+	incremental_vacuum_page_count = 256;
+
+	/*
+		Writes queued for one transaction at most.
+	*/
+	const size_t
+	write_queue_batch_max = 64;
+
+	int64_t
+	get_feed_id (sqlite3** db, const std::string& feed_name);
+
+	struct article_search_entry
+	{
+		public:
+			int64_t article_id = -1;
+			bool has_body = false;
+			std::string headline_text;
+			std::string article_summary;
+			std::string article_text;
+	};
+
+	bool
+	get_article_search_entries (sqlite3** db, const std::string& sql_text,
+	                            const ns_db::sql_parameter_list_type& params,
+	                            std::vector<article_search_entry>& entries);
+
+	bool
+	set_article_search_entries (sqlite3** db, const std::vector<article_search_entry>& entries,
+	                            const bool remove_entries);
+
+	void
+	delete_feed_articles_search (sqlite3** db, const std::string& feed_where_sql_text,
+	                             const ns_db::sql_parameter_list_type& params);
+
+	bool
+	insert_feed_headline (sqlite3** db, const int64_t feed_id, ns_data_read::rss_article& article);
+
+	bool
+	set_feed_retrieved (sqlite3** db, const std::string& feed_url);
+
+	bool
+	insert_feed_config (sqlite3** db, const std::string& feed_name, const std::string& feed_url,
+	                    const std::string& retrieve_limit_hrs, const std::string& retention_days);
+
+	bool
+	store_feed_headlines (sqlite3** db, const std::string& feed_url, ns_data_read::articles_list_type& articles);
+
+	void
+	sql_article_fingerprint (sqlite3_context* context, int arg_count, sqlite3_value** args);
+
+	void
+	sql_article_plain_text (sqlite3_context* context, int arg_count, sqlite3_value** args);
+
+	void
+	sql_article_compress (sqlite3_context* context, int arg_count, sqlite3_value** args);
+
+	void
+	sql_parse_article_date (sqlite3_context* context, int arg_count, sqlite3_value** args);
+
+	void
+	get_sql_value_text (sqlite3_value* value, std::string& text);
+
+	void
+	register_sql_functions (sqlite3* db);
+
+	/*
+		Single row writers shared by the public functions.
+		The caller holds the writer connection.
+	*/
+	int64_t
+	get_feed_id (sqlite3** db, const std::string& feed_name)
+	{
+		int64_t feed_id = -1;
+
+		const std::string sql_text =
+		    "SELECT \
+				feed_id \
+			FROM feeds \
+			WHERE feed_name = TRIM(@feed_name)";
+
+		ns_db::sql_parameter_list_type params = {
+			feed_name
+		};
+
+		ns_db::sql_cursor cursor;
+
+		if (ns_db::open_cursor (db, sql_text, params, cursor)) {
+			if (ns_db::next_row (cursor)) {
+				feed_id = ns_db::get_column_int64 (cursor, 0);
+			}
+
+			ns_db::close_cursor (cursor);
+		}
+
+		return feed_id;
+	}
+
+	/*
+		FULL TEXT SEARCH INDEX
+
+		feeds_articles_search is contentless, so an entry is removed by passing the text it was
+		added with. Entries are added and removed here, beside the writes that change articles,
+		rather than by triggers. No trigger calls a function only this program registers, so other
+		programs can still update and delete articles. An article they delete leaves its entry
+		behind. Search joins feeds_articles, so such an entry is not returned.
+
+		An article has an entry while it has a body row. The entry holds the headline and the
+		plain text of the stored summary and text.
+	*/
+
+	/*
+		Column order:	article_id, headline_text, article_summary, article_text, has_body
+		Summary and text are read as stored and turned into plain text when the index is written.
+		Returns false when the rows could not all be read.
+	*/
+	bool
+	get_article_search_entries (sqlite3** db, const std::string& sql_text,
+	                            const ns_db::sql_parameter_list_type& params,
+	                            std::vector<article_search_entry>& entries)
+	{
+		bool success = false;
+
+		ns_db::sql_cursor cursor;
+
+		if (ns_db::open_cursor (db, sql_text, params, cursor)) {
+			while (ns_db::next_row (cursor)) {
+				article_search_entry entry;
+
+				entry.article_id = ns_db::get_column_int64 (cursor, 0);
+				entry.headline_text = ns_db::get_column_text (cursor, 1);
+				entry.has_body = ns_db::get_column_int64 (cursor, 4) == 1;
+
+				for (int col_index = 2; col_index < 4; col_index++) {
+					std::string& stored_text = (col_index == 2) ? entry.article_summary : entry.article_text;
+
+					/*Type is checked first. Reading the value can change the type SQLite reports.*/
+					const bool is_compressed = ns_db::is_column_blob (cursor, col_index);
+
+					const std::string_view value = ns_db::get_column_text (cursor, col_index);
+
+					if (is_compressed) {
+						gautier_rss_util::decompress_text (value, stored_text);
+					} else {
+						stored_text = value;
+					}
+				}
+
+				entries.emplace_back (std::move (entry));
+			}
+
+			success = (cursor.step_result == SQLITE_DONE);
+
+			ns_db::close_cursor (cursor);
+		}
+
+		return success;
+	}
+
+	/*
+		Adds the entries to the search index, or removes them when remove_entries is true.
+		Entries without a body are not in the index and are skipped.
+	*/
+	bool
+	set_article_search_entries (sqlite3** db, const std::vector<article_search_entry>& entries,
+	                            const bool remove_entries)
+	{
+		const std::string insert_sql_text =
+		    "INSERT INTO feeds_articles_search \
+			(rowid, headline_text, article_summary, article_text) \
+				VALUES (@article_id, @headline_text, @article_summary, @article_text)";
+
+		const std::string remove_sql_text =
+		    "INSERT INTO feeds_articles_search \
+			(feeds_articles_search, rowid, headline_text, article_summary, article_text) \
+				VALUES ('delete', @article_id, @headline_text, @article_summary, @article_text)";
+
+		bool success = true;
+
+		std::string plain_summary;
+		std::string plain_text;
+
+		for (const article_search_entry& entry : entries) {
+			if (entry.has_body == false) {
+				continue;
+			}
+
+			plain_summary.clear();
+			plain_text.clear();
+
+			gautier_rss_util::convert_markup_to_plain_text (entry.article_summary, plain_summary);
+			gautier_rss_util::convert_markup_to_plain_text (entry.article_text, plain_text);
+
+			ns_db::sql_parameter_list_type params = {
+				std::to_string (entry.article_id),
+				entry.headline_text,
+				plain_summary,
+				plain_text
+			};
+
+			if (ns_db::process_sql (db, remove_entries ? remove_sql_text : insert_sql_text, params) == false) {
+				success = false;
+
+				break;
+			}
+		}
+
+		return success;
+	}
+
+	/*
+		Removes the search entries of the articles of the feeds matched by feed_where_sql_text.
+		Called before the feeds are deleted, while their article bodies can still be read.
+	*/
+	void
+	delete_feed_articles_search (sqlite3** db, const std::string& feed_where_sql_text,
+	                             const ns_db::sql_parameter_list_type& params)
+	{
+		const std::string sql_text =
+		    "SELECT \
+				fa.article_id, fa.headline_text, b.article_summary, b.article_text, 1 \
+			FROM 	feeds AS f INNER JOIN \
+				feeds_articles AS fa ON fa.feed_id = f.feed_id INNER JOIN \
+				feeds_articles_body AS b ON b.article_id = fa.article_id \
+			WHERE 	" + feed_where_sql_text;
+
+		std::vector<article_search_entry> entries;
+
+		get_article_search_entries (db, sql_text, params, entries);
+
+		set_article_search_entries (db, entries, true);
+
+		return;
+	}
+
+	bool
+	insert_feed_headline (sqlite3** db, const int64_t feed_id, ns_data_read::rss_article& article)
+	{
+		/*
+			The fingerprint has a unique index. A known article is found by one index probe.
+			The headline row is written once. The body row is written when new, and
+			afterward only when the summary or text changed.
+		*/
+		const std::string headline_sql_text =
+		    "INSERT INTO feeds_articles \
+			(feed_id, \
+			headline_text, \
+			article_date, \
+			article_date_epoch, \
+			article_url, \
+			row_insert_date_time, \
+			row_insert_epoch, \
+			article_fingerprint) \
+				VALUES ( \
+					@feed_id, \
+					TRIM(@headline_text), \
+					TRIM(@article_date), \
+					@article_date_epoch, \
+					TRIM(@feed_url), \
+					datetime('now'), \
+					CAST(STRFTIME('%s', 'now') AS INTEGER), \
+					@article_fingerprint) \
+			ON CONFLICT (article_fingerprint) DO NOTHING";
+
+		const std::string body_sql_text =
+		    "INSERT INTO feeds_articles_body \
+			(article_id, \
+			article_summary, \
+			article_text) \
+				SELECT \
+					article_id, \
+					article_compress(TRIM(@article_summary)), \
+					article_compress(TRIM(@article_text)) \
+				FROM 	feeds_articles \
+				WHERE 	article_fingerprint = @article_fingerprint \
+			ON CONFLICT (article_id) DO UPDATE SET \
+				article_summary = excluded.article_summary, \
+				article_text = excluded.article_text \
+			WHERE 	article_summary IS NOT excluded.article_summary OR \
+				article_text IS NOT excluded.article_text";
+
+		const std::string feed_key = std::to_string (feed_id);
+
+		const std::string fingerprint = std::to_string (gautier_rss_util::get_article_fingerprint (feed_key,
+		                                article.headline, article.url));
+
+		/*
+			Articles without a readable publication date are placed at the time they were stored.
+		*/
+		int64_t article_date_epoch = 0;
+
+		if (gautier_rss_util::parse_publication_date (article.article_date, article_date_epoch) == false) {
+			article_date_epoch = gautier_rss_util::get_current_epoch_seconds();
+		}
+
+		ns_db::sql_parameter_list_type headline_params = {
+			feed_key,
+			article.headline,
+			article.article_date,
+			std::to_string (article_date_epoch),
+			article.url,
+			fingerprint
+		};
+
+		if (ns_db::process_sql (db, headline_sql_text, headline_params) == false) {
+			return false;
+		}
+
+		/*
+			The search entry is replaced only when the body row is written.
+			The body is read as stored, before and after, so the entry matches the stored text.
+		*/
+		const std::string search_sql_text =
+		    "SELECT \
+				fa.article_id, fa.headline_text, b.article_summary, b.article_text, \
+				b.article_id IS NOT NULL \
+			FROM 	feeds_articles AS fa LEFT OUTER JOIN \
+				feeds_articles_body AS b ON b.article_id = fa.article_id \
+			WHERE 	fa.article_fingerprint = @article_fingerprint";
+
+		const ns_db::sql_parameter_list_type search_params = {
+			fingerprint
+		};
+
+		std::vector<article_search_entry> previous_entries;
+
+		bool success = get_article_search_entries (db, search_sql_text, search_params, previous_entries);
+
+		ns_db::sql_parameter_list_type body_params = {
+			article.article_summary,
+			article.article_text,
+			fingerprint
+		};
+
+		if (success) {
+			success = ns_db::process_sql (db, body_sql_text, body_params);
+		}
+
+		if (success && ns_db::get_changed_row_count (db) > 0) {
+			std::vector<article_search_entry> entries;
+
+			success = set_article_search_entries (db, previous_entries, true) &&
+			          get_article_search_entries (db, search_sql_text, search_params, entries) &&
+			          set_article_search_entries (db, entries, false);
+		}
+
+		return success;
+	}
+
+	/*
+		SQL function article_fingerprint(feed_key, headline_text, article_url).
+		Used by the schema migration that fills the column for existing articles.
+	*/
+	void
+	sql_article_fingerprint (sqlite3_context* context, int arg_count, sqlite3_value** args)
+	{
+		std::string values[3];
+
+		for (int i = 0; i < arg_count && i < 3; i++) {
+			const unsigned char* text = sqlite3_value_text (args[i]);
+
+			if (text) {
+				values[i] = (const char*) (text);
+			}
+		}
+
+		const int64_t fingerprint = gautier_rss_util::get_article_fingerprint (values[0], values[1], values[2]);
+
+		sqlite3_result_int64 (context, fingerprint);
+
+		return;
+	}
+
+	/*
+		SQL function article_plain_text(text).
+		Used by the migration that builds the full text search index. Must give the same result
+		as set_article_search_entries, or rows cannot be removed from the search index.
+	*/
+	void
+	sql_article_plain_text (sqlite3_context* context, int arg_count, sqlite3_value** args)
+	{
+		if (arg_count > 0 && sqlite3_value_type (args[0]) != SQLITE_NULL) {
+			std::string text;
+
+			get_sql_value_text (args[0], text);
+
+			std::string plain_text;
+
+			gautier_rss_util::convert_markup_to_plain_text (text, plain_text);
+
+			sqlite3_result_text (context, plain_text.data(), (int) (plain_text.size()), SQLITE_TRANSIENT);
+		} else {
+			sqlite3_result_null (context);
+		}
+
+		return;
+	}
+
+	/*
+		SQL function article_compress(text).
+		Gives the stored form of an article summary or text: a compressed BLOB when
+		compression is on and saves space, otherwise TEXT. A BLOB argument is expanded
+		first so stored values can be rewritten with the current setting.
+	*/
+	void
+	sql_article_compress (sqlite3_context* context, int arg_count, sqlite3_value** args)
+	{
+		if (arg_count > 0 && sqlite3_value_type (args[0]) != SQLITE_NULL) {
+			std::string text;
+
+			get_sql_value_text (args[0], text);
+
+			std::string compressed;
+
+			if (article_compression_enabled && text.size() >= article_compression_min_size) {
+				gautier_rss_util::compress_text (text, compressed);
+			}
+
+			if (compressed.empty() == false) {
+				sqlite3_result_blob (context, compressed.data(), (int) (compressed.size()), SQLITE_TRANSIENT);
+			} else {
+				sqlite3_result_text (context, text.data(), (int) (text.size()), SQLITE_TRANSIENT);
+			}
+		} else {
+			sqlite3_result_null (context);
+		}
+
+		return;
+	}
+
+	/*
+		SQL function parse_article_date(article_date).
+		Epoch seconds of a publication date, or NULL when the date cannot be read.
+	*/
+	void
+	sql_parse_article_date (sqlite3_context* context, int arg_count, sqlite3_value** args)
+	{
+		int64_t epoch_seconds = 0;
+
+		bool parsed = false;
+
+		if (arg_count > 0 && sqlite3_value_type (args[0]) == SQLITE_TEXT) {
+			const char* text = (const char*)sqlite3_value_text (args[0]);
+			const int text_size = sqlite3_value_bytes (args[0]);
+
+			parsed = gautier_rss_util::parse_publication_date (std::string_view (text, (size_t)text_size), epoch_seconds);
+		}
+
+		if (parsed) {
+			sqlite3_result_int64 (context, epoch_seconds);
+		} else {
+			sqlite3_result_null (context);
+		}
+
+		return;
+	}
+
+	/*
+		Text of an article column value. Compressed (BLOB) values are expanded.
+	*/
+	void
+	get_sql_value_text (sqlite3_value* value, std::string& text)
+	{
+		const int value_type = sqlite3_value_type (value);
+
+		if (value_type == SQLITE_BLOB) {
+			const char* bytes = (const char*) (sqlite3_value_blob (value));
+			const int byte_count = sqlite3_value_bytes (value);
+
+			if (bytes) {
+				gautier_rss_util::decompress_text (std::string_view (bytes, (size_t) (byte_count)), text);
+			}
+		} else if (value_type != SQLITE_NULL) {
+			const char* chars = (const char*) (sqlite3_value_text (value));
+			const int byte_count = sqlite3_value_bytes (value);
+
+			if (chars) {
+				text.assign (chars, (size_t) (byte_count));
+			}
+		}
+
+		return;
+	}
+
+	/*
+		Functions used by the migrations and the writes.
+		Registered on the writer connection before any migration or write.
+	*/
+	void
+	register_sql_functions (sqlite3* db)
+	{
+		sqlite3_create_function_v2 (db, "article_fingerprint", 3, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+		                            sql_article_fingerprint, nullptr, nullptr, nullptr);
+
+		sqlite3_create_function_v2 (db, "article_plain_text", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+		                            sql_article_plain_text, nullptr, nullptr, nullptr);
+
+		sqlite3_create_function_v2 (db, "article_compress", 1, SQLITE_UTF8, nullptr,
+		                            sql_article_compress, nullptr, nullptr, nullptr);
+
+		sqlite3_create_function_v2 (db, "parse_article_date", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+		                            sql_parse_article_date, nullptr, nullptr, nullptr);
+
+		return;
+	}
+
+	bool
+	insert_feed_config (sqlite3** db, const std::string& feed_name, const std::string& feed_url,
+	                    const std::string& retrieve_limit_hrs, const std::string& retention_days)
+	{
+		const std::string sql_text =
+		    "INSERT INTO feeds (feed_name, \
+			feed_url, \
+			last_retrieved, \
+			retrieve_limit_hrs, \
+			retention_days) \
+			SELECT \
+				TRIM(@feed_name), \
+				TRIM(@feed_url), \
+				date('now', '-1 day'), \
+				@retrieve_limit_hrs, \
+				@retention_days \
+			WHERE 0 = ( \
+				SELECT \
+					COUNT(*) \
+				FROM 	feeds \
+				WHERE 	feed_name = @feed_name \
+			)";
+
+		ns_db::sql_parameter_list_type params = {
+			feed_name,
+			feed_url,
+			retrieve_limit_hrs,
+			retention_days
+		};
+
+		return ns_db::process_sql (db, sql_text, params);
+	}
+
+	/*
+		Stops at the first failed statement and returns false. The caller rolls back,
+		so a feed is never marked retrieved without its articles.
+	*/
+	bool
+	store_feed_headlines (sqlite3** db, const std::string& feed_url, ns_data_read::articles_list_type& articles)
+	{
+		if (feed_url.empty() == false && set_feed_retrieved (db, feed_url) == false) {
+			return false;
+		}
+
+		/*
+			A download holds lines of one feed. The id is looked up again only when the name changes.
+		*/
+		std::string feed_name;
+		int64_t feed_id = -1;
+
+		for (ns_data_read::rss_article& article : articles) {
+			if (article.feed_name != feed_name) {
+				feed_name = article.feed_name;
+				feed_id = get_feed_id (db, feed_name);
+			}
+
+			if (feed_id > 0 && insert_feed_headline (db, feed_id, article) == false) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool
+	set_feed_retrieved (sqlite3** db, const std::string& feed_url)
+	{
+		const std::string sql_text =
+		    "UPDATE 	feeds SET \
+				last_retrieved = datetime('now') \
+			WHERE 	feed_url = @feed_url";
+
+		ns_db::sql_parameter_list_type params = {
+			feed_url
+		};
+
+		return ns_db::process_sql (db, sql_text, params);
+	}
+
+	void
+	finalize_feed_lines (const std::string& feed_name, const std::string& download_date,
+	                     ns_data_read::articles_list_type& feed_lines);
+
+	ns_db::sql_migration_list_type
+	get_schema_migrations();
+
+	/*
+		DATABASE SCHEMA
+
+		Each entry moves the schema forward by one version (PRAGMA user_version).
+		Never change a released entry. Add a new version to the end of the list.
+
+		The functions in register_sql_functions exist only on this program's writer connection.
+		Migrations and statements in this file may call them. Triggers, defaults and views must not.
+		Other programs that open the database (the sqlite3 shell, backup or cleanup scripts) do not
+		have them and every write that fired such a trigger would fail.
+	*/
+	ns_db::sql_migration_list_type
+	get_schema_migrations()
+	{
+		ns_db::sql_migration_list_type migrations;
+
+		/*
+			Version 1 - Base tables.
+
+			The following was generated by 'DB Browser for SQLite' on 3/13/2020.
+			Databases created before schema versioning already have these tables.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			1, {
+				"CREATE TABLE IF NOT EXISTS \"feeds_articles\" ( \
+    \"feed_name\" TEXT NOT NULL, \
+    \"headline_text\" TEXT NOT NULL, \
+    \"article_summary\" TEXT, \
+    \"article_text\" TEXT, \
+    \"article_date\" TEXT, \
+    \"article_url\" TEXT NOT NULL, \
+    \"row_insert_date_time\" TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP \
+);",
+				"CREATE TABLE IF NOT EXISTS \"feeds\" ( \
+    \"feed_name\" TEXT, \
+    \"feed_url\" TEXT, \
+    \"last_retrieved\" TEXT, \
+    \"retrieve_limit_hrs\" TEXT, \
+    \"retention_days\" TEXT \
+);"
+			}
+		});
+
+		/*
+			Version 2 - Indexes for the article access paths.
+
+			feed_name			per feed reads ordered by rowid (rowid is the implicit last key)
+			feed_name, headline_text	article summary lookup
+			article_url			article row id lookup
+			UPPER(feed_name), UPPER(headline_text)
+							duplicate check in set_feed_headline
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			2, {
+				"CREATE INDEX IF NOT EXISTS feeds_articles_feed_name ON feeds_articles (feed_name);",
+				"CREATE INDEX IF NOT EXISTS feeds_articles_feed_headline ON feeds_articles (feed_name, headline_text);",
+				"CREATE INDEX IF NOT EXISTS feeds_articles_article_url ON feeds_articles (article_url);",
+				"CREATE INDEX IF NOT EXISTS feeds_articles_headline_key ON feeds_articles (UPPER(feed_name), UPPER(headline_text));",
+				"CREATE INDEX IF NOT EXISTS feeds_feed_name ON feeds (feed_name);",
+				"CREATE INDEX IF NOT EXISTS feeds_feed_url ON feeds (feed_url);"
+			}
+		});
+
+		/*
+			Version 3 - Case-insensitive keys.
+
+			feed_name, feed_url and headline_text compare with COLLATE NOCASE.
+			Lookups written as column = @value then use the indexes directly instead of
+			comparing UPPER() of every row. Tables are rebuilt because SQLite cannot change
+			the collation of an existing column. Row ids are carried over unchanged.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			3, {
+				"CREATE TABLE feeds_articles_v3 ( \
+					feed_name TEXT NOT NULL COLLATE NOCASE, \
+					headline_text TEXT NOT NULL COLLATE NOCASE, \
+					article_summary TEXT, \
+					article_text TEXT, \
+					article_date TEXT, \
+					article_url TEXT NOT NULL, \
+					row_insert_date_time TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP \
+				);",
+				"INSERT INTO feeds_articles_v3 (rowid, feed_name, headline_text, article_summary, article_text, \
+					article_date, article_url, row_insert_date_time) \
+				SELECT rowid, feed_name, headline_text, article_summary, article_text, \
+					article_date, article_url, row_insert_date_time \
+				FROM feeds_articles;",
+				"DROP TABLE feeds_articles;",
+				"ALTER TABLE feeds_articles_v3 RENAME TO feeds_articles;",
+				"CREATE INDEX feeds_articles_feed_name ON feeds_articles (feed_name);",
+				"CREATE INDEX feeds_articles_feed_headline ON feeds_articles (feed_name, headline_text);",
+				"CREATE INDEX feeds_articles_article_url ON feeds_articles (article_url);",
+
+				"CREATE TABLE feeds_v3 ( \
+					feed_name TEXT COLLATE NOCASE, \
+					feed_url TEXT COLLATE NOCASE, \
+					last_retrieved TEXT, \
+					retrieve_limit_hrs TEXT, \
+					retention_days TEXT \
+				);",
+				"INSERT INTO feeds_v3 (rowid, feed_name, feed_url, last_retrieved, retrieve_limit_hrs, retention_days) \
+				SELECT rowid, feed_name, feed_url, last_retrieved, retrieve_limit_hrs, retention_days \
+				FROM feeds;",
+				"DROP TABLE feeds;",
+				"ALTER TABLE feeds_v3 RENAME TO feeds;",
+				"CREATE INDEX feeds_feed_name ON feeds (feed_name);",
+				"CREATE INDEX feeds_feed_url ON feeds (feed_url);"
+			}
+		});
+
+		/*
+			Version 4 - Article fingerprint.
+
+			A 64-bit hash of feed name, normalized headline and url (see get_article_fingerprint).
+			The unique index turns the duplicate check into a single index probe.
+			Existing rows get their fingerprint from the article_fingerprint SQL function.
+			Rows that hash the same as an older row are removed before the index is built.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			4, {
+				"ALTER TABLE feeds_articles ADD COLUMN article_fingerprint INTEGER;",
+				"UPDATE feeds_articles SET \
+					article_fingerprint = article_fingerprint(feed_name, headline_text, article_url);",
+				"DELETE FROM feeds_articles \
+				WHERE rowid NOT IN ( \
+					SELECT MIN(rowid) FROM feeds_articles GROUP BY article_fingerprint \
+				);",
+				"CREATE UNIQUE INDEX feeds_articles_fingerprint ON feeds_articles (article_fingerprint);"
+			}
+		});
+
+		/*
+			Version 5 - Articles reference feeds by id.
+
+			feeds gets feed_id INTEGER PRIMARY KEY so ids survive VACUUM.
+			feeds_articles keeps feed_id instead of repeating the feed name. A feed rename
+			updates one row and deleting a feed removes its articles (ON DELETE CASCADE).
+			Articles whose feed name has no configuration cannot be shown and are not copied.
+			Fingerprints are recomputed from feed_id so they no longer depend on the name.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			5, {
+				"CREATE TABLE feeds_v5 ( \
+					feed_id INTEGER PRIMARY KEY, \
+					feed_name TEXT COLLATE NOCASE, \
+					feed_url TEXT COLLATE NOCASE, \
+					last_retrieved TEXT, \
+					retrieve_limit_hrs TEXT, \
+					retention_days TEXT \
+				);",
+				"INSERT INTO feeds_v5 (feed_id, feed_name, feed_url, last_retrieved, retrieve_limit_hrs, retention_days) \
+				SELECT rowid, feed_name, feed_url, last_retrieved, retrieve_limit_hrs, retention_days \
+				FROM feeds;",
+				"DROP TABLE feeds;",
+				"ALTER TABLE feeds_v5 RENAME TO feeds;",
+				"CREATE INDEX feeds_feed_name ON feeds (feed_name);",
+				"CREATE INDEX feeds_feed_url ON feeds (feed_url);",
+
+				"CREATE TABLE feeds_articles_v5 ( \
+					feed_id INTEGER NOT NULL REFERENCES feeds (feed_id) ON DELETE CASCADE, \
+					headline_text TEXT NOT NULL COLLATE NOCASE, \
+					article_summary TEXT, \
+					article_text TEXT, \
+					article_date TEXT, \
+					article_url TEXT NOT NULL, \
+					row_insert_date_time TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP, \
+					article_fingerprint INTEGER \
+				);",
+				"INSERT INTO feeds_articles_v5 (rowid, feed_id, headline_text, article_summary, article_text, \
+					article_date, article_url, row_insert_date_time, article_fingerprint) \
+				SELECT fa.rowid, f.feed_id, fa.headline_text, fa.article_summary, fa.article_text, \
+					fa.article_date, fa.article_url, fa.row_insert_date_time, \
+					article_fingerprint(f.feed_id, fa.headline_text, fa.article_url) \
+				FROM feeds_articles AS fa INNER JOIN \
+					feeds AS f ON f.feed_id = ( \
+						SELECT MIN(feed_id) FROM feeds WHERE feed_name = fa.feed_name \
+					);",
+				"DROP TABLE feeds_articles;",
+				"ALTER TABLE feeds_articles_v5 RENAME TO feeds_articles;",
+				"DELETE FROM feeds_articles \
+				WHERE rowid NOT IN ( \
+					SELECT MIN(rowid) FROM feeds_articles GROUP BY article_fingerprint \
+				);",
+				"CREATE INDEX feeds_articles_feed_id ON feeds_articles (feed_id);",
+				"CREATE INDEX feeds_articles_feed_headline ON feeds_articles (feed_id, headline_text);",
+				"CREATE INDEX feeds_articles_article_url ON feeds_articles (article_url);",
+				"CREATE UNIQUE INDEX feeds_articles_fingerprint ON feeds_articles (article_fingerprint);"
+			}
+		});
+
+		/*
+			Version 6 - Article counters kept on the feed row.
+
+			Triggers keep feeds.article_count and feeds.article_max_row_id in step with feeds_articles.
+			Listing feeds then reads only the feeds table, however many articles are retained.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			6, {
+				"ALTER TABLE feeds ADD COLUMN article_count INTEGER NOT NULL DEFAULT 0;",
+				"ALTER TABLE feeds ADD COLUMN article_max_row_id INTEGER NOT NULL DEFAULT -1;",
+				"UPDATE feeds SET \
+					article_count = (SELECT COUNT(*) FROM feeds_articles WHERE feed_id = feeds.feed_id), \
+					article_max_row_id = (SELECT IFNULL(MAX(rowid), -1) FROM feeds_articles WHERE feed_id = feeds.feed_id);",
+				"CREATE TRIGGER feeds_articles_count_insert AFTER INSERT ON feeds_articles \
+				BEGIN \
+					UPDATE feeds SET \
+						article_count = article_count + 1, \
+						article_max_row_id = MAX(article_max_row_id, NEW.rowid) \
+					WHERE feed_id = NEW.feed_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_count_delete AFTER DELETE ON feeds_articles \
+				BEGIN \
+					UPDATE feeds SET \
+						article_count = article_count - 1, \
+						article_max_row_id = CASE \
+							WHEN article_max_row_id = OLD.rowid THEN \
+								(SELECT IFNULL(MAX(rowid), -1) FROM feeds_articles WHERE feed_id = OLD.feed_id) \
+							ELSE article_max_row_id END \
+					WHERE feed_id = OLD.feed_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_count_move AFTER UPDATE OF feed_id ON feeds_articles \
+					WHEN OLD.feed_id IS NOT NEW.feed_id \
+				BEGIN \
+					UPDATE feeds SET \
+						article_count = article_count - 1, \
+						article_max_row_id = (SELECT IFNULL(MAX(rowid), -1) FROM feeds_articles WHERE feed_id = OLD.feed_id) \
+					WHERE feed_id = OLD.feed_id; \
+					UPDATE feeds SET \
+						article_count = article_count + 1, \
+						article_max_row_id = MAX(article_max_row_id, NEW.rowid) \
+					WHERE feed_id = NEW.feed_id; \
+				END;"
+			}
+		});
+
+		/*
+			Version 7 - Full text search.
+
+			feeds_articles_search is a contentless FTS5 index over the headline and the plain text
+			of summary and body. Its rowid is the feeds_articles rowid. Triggers keep it in step.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			7, {
+				"CREATE VIRTUAL TABLE feeds_articles_search USING fts5 ( \
+					headline_text, article_summary, article_text, \
+					content = '', tokenize = 'unicode61 remove_diacritics 2' \
+				);",
+				"INSERT INTO feeds_articles_search (rowid, headline_text, article_summary, article_text) \
+				SELECT rowid, headline_text, article_plain_text(article_summary), article_plain_text(article_text) \
+				FROM feeds_articles;",
+				"CREATE TRIGGER feeds_articles_search_insert AFTER INSERT ON feeds_articles \
+				BEGIN \
+					INSERT INTO feeds_articles_search (rowid, headline_text, article_summary, article_text) \
+					VALUES (NEW.rowid, NEW.headline_text, \
+						article_plain_text(NEW.article_summary), article_plain_text(NEW.article_text)); \
+				END;",
+				"CREATE TRIGGER feeds_articles_search_delete AFTER DELETE ON feeds_articles \
+				BEGIN \
+					INSERT INTO feeds_articles_search (feeds_articles_search, rowid, headline_text, article_summary, article_text) \
+					VALUES ('delete', OLD.rowid, OLD.headline_text, \
+						article_plain_text(OLD.article_summary), article_plain_text(OLD.article_text)); \
+				END;",
+				"CREATE TRIGGER feeds_articles_search_update AFTER UPDATE OF headline_text, article_summary, article_text \
+					ON feeds_articles \
+				BEGIN \
+					INSERT INTO feeds_articles_search (feeds_articles_search, rowid, headline_text, article_summary, article_text) \
+					VALUES ('delete', OLD.rowid, OLD.headline_text, \
+						article_plain_text(OLD.article_summary), article_plain_text(OLD.article_text)); \
+					INSERT INTO feeds_articles_search (rowid, headline_text, article_summary, article_text) \
+					VALUES (NEW.rowid, NEW.headline_text, \
+						article_plain_text(NEW.article_summary), article_plain_text(NEW.article_text)); \
+				END;"
+			}
+		});
+
+		/*
+			Version 8 - Headlines apart from article bodies.
+
+			feeds_articles keeps the short columns read when listing and paging headlines.
+			Summary and text move to feeds_articles_body, one row per article keyed by article_id.
+			Listing headlines then reads far fewer pages.
+
+			article_id is declared as INTEGER PRIMARY KEY (the rowid) so the body can reference it.
+			The body is removed with its article (ON DELETE CASCADE). Full text search entries
+			are removed before the article is, while the body can still be read.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			8, {
+				"CREATE TABLE feeds_articles_v8 ( \
+					article_id INTEGER PRIMARY KEY, \
+					feed_id INTEGER NOT NULL REFERENCES feeds (feed_id) ON DELETE CASCADE, \
+					headline_text TEXT NOT NULL COLLATE NOCASE, \
+					article_date TEXT, \
+					article_url TEXT NOT NULL, \
+					row_insert_date_time TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP, \
+					article_fingerprint INTEGER \
+				);",
+				"INSERT INTO feeds_articles_v8 (article_id, feed_id, headline_text, article_date, article_url, \
+					row_insert_date_time, article_fingerprint) \
+				SELECT rowid, feed_id, headline_text, article_date, article_url, \
+					row_insert_date_time, article_fingerprint \
+				FROM feeds_articles;",
+				"CREATE TABLE feeds_articles_body ( \
+					article_id INTEGER PRIMARY KEY REFERENCES feeds_articles (article_id) ON DELETE CASCADE, \
+					article_summary TEXT, \
+					article_text TEXT \
+				);",
+				"INSERT INTO feeds_articles_body (article_id, article_summary, article_text) \
+				SELECT rowid, article_summary, article_text \
+				FROM feeds_articles;",
+				"DROP TABLE feeds_articles;",
+				"ALTER TABLE feeds_articles_v8 RENAME TO feeds_articles;",
+				"CREATE INDEX feeds_articles_feed_id ON feeds_articles (feed_id);",
+				"CREATE INDEX feeds_articles_feed_headline ON feeds_articles (feed_id, headline_text);",
+				"CREATE INDEX feeds_articles_article_url ON feeds_articles (article_url);",
+				"CREATE UNIQUE INDEX feeds_articles_fingerprint ON feeds_articles (article_fingerprint);",
+
+				"CREATE TRIGGER feeds_articles_count_insert AFTER INSERT ON feeds_articles \
+				BEGIN \
+					UPDATE feeds SET \
+						article_count = article_count + 1, \
+						article_max_row_id = MAX(article_max_row_id, NEW.article_id) \
+					WHERE feed_id = NEW.feed_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_count_delete AFTER DELETE ON feeds_articles \
+				BEGIN \
+					UPDATE feeds SET \
+						article_count = article_count - 1, \
+						article_max_row_id = CASE \
+							WHEN article_max_row_id = OLD.article_id THEN \
+								(SELECT IFNULL(MAX(article_id), -1) FROM feeds_articles WHERE feed_id = OLD.feed_id) \
+							ELSE article_max_row_id END \
+					WHERE feed_id = OLD.feed_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_count_move AFTER UPDATE OF feed_id ON feeds_articles \
+					WHEN OLD.feed_id IS NOT NEW.feed_id \
+				BEGIN \
+					UPDATE feeds SET \
+						article_count = article_count - 1, \
+						article_max_row_id = (SELECT IFNULL(MAX(article_id), -1) FROM feeds_articles WHERE feed_id = OLD.feed_id) \
+					WHERE feed_id = OLD.feed_id; \
+					UPDATE feeds SET \
+						article_count = article_count + 1, \
+						article_max_row_id = MAX(article_max_row_id, NEW.article_id) \
+					WHERE feed_id = NEW.feed_id; \
+				END;",
+
+				"CREATE TRIGGER feeds_articles_search_delete BEFORE DELETE ON feeds_articles \
+				BEGIN \
+					INSERT INTO feeds_articles_search (feeds_articles_search, rowid, headline_text, article_summary, article_text) \
+					SELECT 'delete', OLD.article_id, OLD.headline_text, \
+						article_plain_text(article_summary), article_plain_text(article_text) \
+					FROM feeds_articles_body WHERE article_id = OLD.article_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_search_headline AFTER UPDATE OF headline_text ON feeds_articles \
+				BEGIN \
+					INSERT INTO feeds_articles_search (feeds_articles_search, rowid, headline_text, article_summary, article_text) \
+					SELECT 'delete', OLD.article_id, OLD.headline_text, \
+						article_plain_text(article_summary), article_plain_text(article_text) \
+					FROM feeds_articles_body WHERE article_id = OLD.article_id; \
+					INSERT INTO feeds_articles_search (rowid, headline_text, article_summary, article_text) \
+					SELECT NEW.article_id, NEW.headline_text, \
+						article_plain_text(article_summary), article_plain_text(article_text) \
+					FROM feeds_articles_body WHERE article_id = NEW.article_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_body_search_insert AFTER INSERT ON feeds_articles_body \
+				BEGIN \
+					INSERT INTO feeds_articles_search (rowid, headline_text, article_summary, article_text) \
+					SELECT NEW.article_id, headline_text, \
+						article_plain_text(NEW.article_summary), article_plain_text(NEW.article_text) \
+					FROM feeds_articles WHERE article_id = NEW.article_id; \
+				END;",
+				"CREATE TRIGGER feeds_articles_body_search_update AFTER UPDATE OF article_summary, article_text \
+					ON feeds_articles_body \
+				BEGIN \
+					INSERT INTO feeds_articles_search (feeds_articles_search, rowid, headline_text, article_summary, article_text) \
+					SELECT 'delete', OLD.article_id, headline_text, \
+						article_plain_text(OLD.article_summary), article_plain_text(OLD.article_text) \
+					FROM feeds_articles WHERE article_id = OLD.article_id; \
+					INSERT INTO feeds_articles_search (rowid, headline_text, article_summary, article_text) \
+					SELECT NEW.article_id, headline_text, \
+						article_plain_text(NEW.article_summary), article_plain_text(NEW.article_text) \
+					FROM feeds_articles WHERE article_id = NEW.article_id; \
+				END;"
+			}
+		});
+
+		/*
+			Version 9 - Insert time as epoch seconds.
+
+			Retention compares row_insert_epoch with a cutoff through the (feed_id, row_insert_epoch)
+			index instead of applying DATE() to the text timestamp of every row.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			9, {
+				"ALTER TABLE feeds_articles ADD COLUMN row_insert_epoch INTEGER NOT NULL DEFAULT 0;",
+				"UPDATE feeds_articles SET \
+					row_insert_epoch = IFNULL(CAST(STRFTIME('%s', row_insert_date_time) AS INTEGER), 0);",
+				"CREATE INDEX feeds_articles_feed_insert_epoch ON feeds_articles (feed_id, row_insert_epoch);"
+			}
+		});
+
+		/*
+			Version 10 - Publication date as epoch seconds.
+
+			article_date keeps the text from the feed. article_date_epoch is that date read
+			into epoch seconds, or the insert time when the feed's date cannot be read.
+			Articles are listed and range queried by publication time through the
+			(feed_id, article_date_epoch) index.
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			10, {
+				"ALTER TABLE feeds_articles ADD COLUMN article_date_epoch INTEGER NOT NULL DEFAULT 0;",
+				"UPDATE feeds_articles SET \
+					article_date_epoch = IFNULL(parse_article_date(article_date), row_insert_epoch);",
+				"CREATE INDEX feeds_articles_feed_date_epoch ON feeds_articles (feed_id, article_date_epoch);"
+			}
+		});
+
+		/*
+			Version 11 - Search index kept by rss_writer.
+
+			The search triggers of version 8 called article_plain_text. A delete or update of an
+			article from any other program failed with "no such function: article_plain_text".
+			The triggers are dropped. Search entries are now added and removed next to the
+			writes that change articles (see FULL TEXT SEARCH INDEX).
+		*/
+		migrations.emplace_back (ns_db::sql_migration {
+			11, {
+				"DROP TRIGGER IF EXISTS feeds_articles_search_delete;",
+				"DROP TRIGGER IF EXISTS feeds_articles_search_headline;",
+				"DROP TRIGGER IF EXISTS feeds_articles_body_search_insert;",
+				"DROP TRIGGER IF EXISTS feeds_articles_body_search_update;"
+			}
+		});
+
+		return migrations;
+	}
+
+	/*
+		Prepares parsed lines for storage and drops lines missing a headline or url.
+	*/
+	void
+	finalize_feed_lines (const std::string& feed_name, const std::string& download_date,
+	                     ns_data_read::articles_list_type& feed_lines)
+	{
+		ns_data_read::articles_list_type good_lines;
+
+		good_lines.reserve (feed_lines.size());
+
+		for (ns_data_read::rss_article& article : feed_lines) {
+			const bool article_good = ns_data_read::finalize_rss_article (feed_name, download_date, article);
+
+			if (article_good) {
+				good_lines.emplace_back (std::move (article));
+			}
+		}
+
+		feed_lines.swap (good_lines);
+
+		return;
+	}
+
+	/*
+		A feed being updated: its article row id before the download and its queued writes.
+	*/
+	struct feed_update
+	{
+		public:
+			std::string feed_name;
+			int64_t rowid = -1;
+			std::vector<std::future<bool>> pending_writes;
+	};
+
+	/*
+		Writes go through the write queue. The futures of the queued writes are added to pending_writes.
+		The next feed can be downloaded while these writes are committed.
+	*/
 	long
 	update_rss_db_from_network_impl (const std::string db_file_name,
 	                                 const std::string feed_name,
 	                                 const std::string feed_url,
 	                                 const std::string retrieve_limit_hrs,
-	                                 const std::string retention_days)
+	                                 const std::string retention_days,
+	                                 std::vector<std::future<bool>>& pending_writes)
 	{
 		long response_code = 0;
 
-		gautier_rss_data_write::set_feed_config (db_file_name, feed_name, feed_url, retrieve_limit_hrs, retention_days);
+		/*
+			Read before the feed config is queued. A feed that is not stored yet has never been retrieved.
+			The queued insert leaves a stored feed unchanged.
+		*/
+		ns_data_read::rss_feed feed;
+
+		ns_data_read::get_feed (db_file_name, feed_name, feed);
 
-		const bool is_feed_still_fresh = ns_data_read::is_feed_still_fresh (db_file_name, feed_name, false);
+		const bool is_feed_still_fresh = feed.feed_name.empty() == false &&
+		                                 ns_data_read::is_feed_still_fresh (feed, false);
+
+		pending_writes.push_back (gautier_rss_data_write::queue_feed_config (db_file_name, feed_name, feed_url,
+		                          retrieve_limit_hrs, retention_days));
 
 		if (is_feed_still_fresh == false) {
-			std::string feed_data;
+			ns_data_read::articles_list_type feed_lines;
 
-			response_code = ns_data_read::download_rss_feed (feed_url, feed_data);
+			/*
+				The feed is parsed while it downloads. Each block from the network goes straight to the parser.
+			*/
+			ns_parse::feed_parse_stream parse_stream;
+
+			ns_parse::open_feed_parse_stream (feed_lines, parse_stream);
+
+			response_code = ns_data_read::download_rss_feed (feed_url, [&parse_stream] (std::string_view feed_data) {
+				return ns_parse::write_feed_parse_stream (parse_stream, feed_data);
+			});
+
+			ns_parse::close_feed_parse_stream (parse_stream);
 
 			const bool response_good = ns_data_read::is_network_response_ok (response_code);
 
 			if (response_good) {
 				const std::string download_date = gautier_rss_util::get_current_date_time_utc();
 
-				gautier_rss_data_write::update_feed_retrieved (db_file_name, feed_url);
+				finalize_feed_lines (feed_name, download_date, feed_lines);
 
-				ns_data_read::articles_list_type feed_lines;
+				pending_writes.push_back (gautier_rss_data_write::queue_feed_headlines (db_file_name, feed_url, feed_lines));
+			}
+		}
 
-				ns_parse::get_feed_lines (feed_data, feed_lines);
+		return response_code;
+	}
 
-				for (ns_data_read::rss_article article : feed_lines) {
-					const bool article_good = ns_data_read::finalize_rss_article (feed_name, download_date, article);
+	/*
+		Waits for the queued writes of a feed. True when every write committed.
+		A feed whose writes failed is left as it was and has no new articles to read.
+	*/
+	bool
+	wait_for_feed_writes (const std::string& feed_name, std::vector<std::future<bool>>& pending_writes)
+	{
+		bool committed = true;
 
-					if (article_good) {
-						gautier_rss_data_write::set_feed_headline (db_file_name, article);
-					}
-				}
+		for (std::future<bool>& pending_write : pending_writes) {
+			if (pending_write.get() == false) {
+				committed = false;
 			}
 		}
 
-		return response_code;
+		if (committed == false) {
+			std::cout << __FILE__ << " " << __func__ << " line (" << __LINE__ << ") Feed " << feed_name <<
+			          " was not saved to the database.\n";
+		}
+
+		return committed;
 	}
 }
 /*
@@ -85,8 +1207,8 @@ namespace {
 	Manages the database schema.
 	Creates any tables needed.
 
-	This function does not keep the database open.
-	All it does is initialize the database.
+	This function keeps the database open in a session
+	that lasts until de_initialize_db is called.
 
 	You only need to call it once at the start of a program.
 	Call it once near the start of a program before any other
@@ -98,35 +1220,20 @@ gautier_rss_data_write::initialize_db (const std::string db_file_name)
 	ns_data_read::initialize_network();
 
 	/*
-		The following was generated by 'DB Browser for SQLite' on 3/13/2020.
+		The session opened here is held until de_initialize_db.
+		Every read and write in between reuses the same connections.
 	*/
-	const std::string sql_text_feeds_articles =
-	    "CREATE TABLE IF NOT EXISTS \"feeds_articles\" ( \
-    \"feed_name\" TEXT NOT NULL, \
-    \"headline_text\" TEXT NOT NULL, \
-    \"article_summary\" TEXT, \
-    \"article_text\" TEXT, \
-    \"article_date\" TEXT, \
-    \"article_url\" TEXT NOT NULL, \
-    \"row_insert_date_time\" TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP \
-);";
+	ns_db::open_session (db_file_name);
 
-	const std::string sql_text_feeds =
-	    "CREATE TABLE IF NOT EXISTS \"feeds\" ( \
-    \"feed_name\" TEXT, \
-    \"feed_url\" TEXT, \
-    \"last_retrieved\" TEXT, \
-    \"retrieve_limit_hrs\" TEXT, \
-    \"retention_days\" TEXT \
-);";
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	register_sql_functions (db);
 
-	ns_db::process_sql_simple (&db, sql_text_feeds_articles);
-	ns_db::process_sql_simple (&db, sql_text_feeds);
+	const ns_db::sql_migration_list_type migrations = get_schema_migrations();
 
-	ns_db::close_db (&db);
+	ns_db::migrate_schema (&db, migrations);
+
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -143,40 +1250,11 @@ gautier_rss_data_write::set_feed_config (const std::string db_file_name,
         const std::string retrieve_limit_hrs,
         const std::string retention_days)
 {
-	const std::string sql_text =
-	    "INSERT INTO feeds (feed_name, \
-		feed_url, \
-		last_retrieved, \
-		retrieve_limit_hrs, \
-		retention_days) \
-		SELECT \
-			TRIM(@feed_name), \
-			TRIM(@feed_url), \
-			date('now', '-1 day'), \
-			@retrieve_limit_hrs, \
-			@retention_days \
-		WHERE 0 = ( \
-			SELECT \
-				COUNT(*) \
-			FROM 	feeds \
-			WHERE 	UPPER(feed_name) = UPPER(@feed_name) \
-		)";
-
-	ns_db::sql_parameter_list_type params = {
-		feed_name,
-		feed_url,
-		retrieve_limit_hrs,
-		retention_days
-	};
-
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
-	ns_db::sql_rowset_type rows;
-
-	ns_db::process_sql (&db, sql_text, params, rows);
+	insert_feed_config (&db, feed_name, feed_url, retrieve_limit_hrs, retention_days);
 
-	ns_db::close_db (&db);
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -194,21 +1272,13 @@ gautier_rss_data_write::update_feed_config (const std::string db_file_name,
         const std::string retrieve_limit_hrs,
         const std::string retention_days)
 {
-	ns_data_read::rss_feed feed;
-
-	ns_data_read::get_feed_by_row_id (db_file_name, row_id, feed);
-
-	if (feed.feed_name != feed_name) {
-		update_feed_config_related (db_file_name, feed.feed_name, feed_name);
-	}
-
 	const std::string sql_text =
 	    "UPDATE 	feeds SET\
 			feed_name = TRIM(@feed_name), \
 			feed_url = TRIM(@feed_url), \
 			retrieve_limit_hrs = @retrieve_limit_hrs, \
 			retention_days = @retention_days \
-		WHERE 	rowid = @row_id";
+		WHERE 	feed_id = @row_id";
 
 	ns_db::sql_parameter_list_type params = {
 		feed_name,
@@ -218,15 +1288,13 @@ gautier_rss_data_write::update_feed_config (const std::string db_file_name,
 		std::to_string (row_id)
 	};
 
-	sqlite3* db = nullptr;
-
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
 	ns_db::sql_rowset_type rows;
 
 	ns_db::process_sql (&db, sql_text, params, rows);
 
-	ns_db::close_db (&db);
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -241,9 +1309,9 @@ gautier_rss_data_write::update_feed_config_related (const std::string db_file_na
         const std::string feed_name_old, const std::string feed_name_new)
 {
 	const std::string sql_text =
-	    "UPDATE 	feeds_articles SET \
+	    "UPDATE 	feeds SET \
 			feed_name = TRIM(@feed_name_new) \
-		WHERE 	UPPER(feed_name) = UPPER(@feed_name_old) AND \
+		WHERE 	feed_name = @feed_name_old AND \
 			LENGTH(TRIM(@feed_name_new)) > 1";
 
 	ns_db::sql_parameter_list_type params = {
@@ -251,14 +1319,13 @@ gautier_rss_data_write::update_feed_config_related (const std::string db_file_na
 		feed_name_old
 	};
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
 	ns_db::sql_rowset_type rows;
 
 	ns_db::process_sql (&db, sql_text, params, rows);
 
-	ns_db::close_db (&db);
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -289,20 +1356,54 @@ gautier_rss_data_write::delete_feed (const std::string db_file_name, const std::
 	const std::string sql_text =
 	    "DELETE \
 		FROM 	feeds \
-		WHERE 	UPPER(feed_url) = UPPER(@feed_url)";
+		WHERE 	feed_url = @feed_url";
 
 	ns_db::sql_parameter_list_type params = {
 		feed_url
 	};
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
+
+	const bool transaction_started = ns_db::begin_transaction (&db);
+
+	delete_feed_articles_search (&db, "f.feed_url = @feed_url", params);
+
+	ns_db::sql_rowset_type rows;
+
+	ns_db::process_sql (&db, sql_text, params, rows);
+
+	ns_db::commit_transaction (&db, transaction_started);
+
+	ns_db::release_writer (db_file_name);
+
+	return;
+}
+
+void
+gautier_rss_data_write::delete_feed (const std::string db_file_name, const int64_t feed_id)
+{
+	const std::string sql_text =
+	    "DELETE \
+		FROM 	feeds \
+		WHERE 	feed_id = @feed_id";
+
+	ns_db::sql_parameter_list_type params = {
+		std::to_string (feed_id)
+	};
+
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
+
+	const bool transaction_started = ns_db::begin_transaction (&db);
+
+	delete_feed_articles_search (&db, "f.feed_id = @feed_id", params);
 
 	ns_db::sql_rowset_type rows;
 
 	ns_db::process_sql (&db, sql_text, params, rows);
 
-	ns_db::close_db (&db);
+	ns_db::commit_transaction (&db, transaction_started);
+
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -316,48 +1417,40 @@ void
 gautier_rss_data_write::set_feed_headline (const std::string db_file_name,
         ns_data_read::rss_article& article)
 {
-	const std::string sql_text =
-	    "INSERT INTO feeds_articles \
-		(feed_name, \
-		headline_text, \
-		article_summary, \
-		article_text, \
-		article_date, \
-		article_url, \
-		row_insert_date_time) \
-			SELECT \
-				TRIM(@feed_name), \
-				TRIM(@headline_text), \
-				TRIM(@article_summary), \
-				TRIM(@article_text), \
-				TRIM(@article_date), \
-				TRIM(@feed_url), \
-				datetime('now') \
-		WHERE 0 = ( \
-			SELECT \
-				COUNT(*) \
-			FROM  	feeds_articles \
-			WHERE 	UPPER(feed_name) = UPPER(@feed_name) AND \
-				UPPER(headline_text) = UPPER(@headline_text) \
-		)";
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
-	ns_db::sql_parameter_list_type params = {
-		article.feed_name,
-		article.headline,
-		article.article_summary,
-		article.article_text,
-		article.article_date,
-		article.url
-	};
+	const int64_t feed_id = get_feed_id (&db, article.feed_name);
 
-	sqlite3* db = nullptr;
-	ns_db::open_db (db_file_name, &db);
+	if (feed_id > 0) {
+		insert_feed_headline (&db, feed_id, article);
+	}
 
-	ns_db::sql_rowset_type rows;
+	ns_db::release_writer (db_file_name);
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	return;
+}
+
+/*
+	RSS HEADLINES/ARTICLES
+
+	Stores all lines from one download of an RSS feed in a single transaction.
+	When feed_url is not empty, the feed's last_retrieved date is set in the same transaction.
+*/
+void
+gautier_rss_data_write::set_feed_headlines (const std::string db_file_name, const std::string feed_url,
+        ns_data_read::articles_list_type& articles)
+{
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
-	ns_db::close_db (&db);
+	const bool transaction_started = ns_db::begin_transaction (&db);
+
+	if (store_feed_headlines (&db, feed_url, articles)) {
+		ns_db::commit_transaction (&db, transaction_started);
+	} else {
+		ns_db::rollback_transaction (&db, transaction_started);
+	}
+
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -385,6 +1478,12 @@ gautier_rss_data_write::update_rss_feeds (const std::string db_file_name,
 
 	ns_data_read::get_feeds (db_file_name, rss_feeds);
 
+	/*
+		Each feed is downloaded while the writes of the feed before it are committed.
+		The new articles are read once every write has finished.
+	*/
+	std::vector<feed_update> feed_updates;
+
 	for (ns_data_read::rss_feed feed : rss_feeds) {
 		const std::string feed_name = feed.feed_name;
 
@@ -392,11 +1491,23 @@ gautier_rss_data_write::update_rss_feeds (const std::string db_file_name,
 		const std::string retrieve_limit_hrs = feed.retrieve_limit_hrs;
 		const std::string retention_days = feed.retention_days;
 
+		feed_update& update = feed_updates.emplace_back();
+
+		update.feed_name = feed_name;
+		update.rowid = ns_data_read::get_feed_article_max_row_id (db_file_name, feed_name);
+
+		update_rss_db_from_network_impl (db_file_name, feed_name, feed_url, retrieve_limit_hrs, retention_days,
+		                                 update.pending_writes);
+	}
+
+	for (feed_update& update : feed_updates) {
 		ns_data_read::articles_list_type articles;
 
-		update_rss_db_from_network (db_file_name, feed_name, feed_url, retrieve_limit_hrs, retention_days, articles);
+		if (wait_for_feed_writes (update.feed_name, update.pending_writes)) {
+			ns_data_read::get_feed_articles_after_row_id (db_file_name, update.feed_name, articles, true, update.rowid);
+		}
 
-		feed_data[feed_name] = articles;
+		feed_data[update.feed_name] = articles;
 	}
 
 	return;
@@ -491,24 +1602,11 @@ gautier_rss_data_write::download_feeds (const std::string db_file_name, int_fast
 void
 gautier_rss_data_write::update_feed_retrieved (const std::string db_file_name, const std::string feed_url)
 {
-	const std::string sql_text =
-	    "UPDATE 	feeds SET \
-			last_retrieved = datetime('now') \
-		WHERE 	UPPER(feed_url) = UPPER(@feed_url)";
-
-	ns_db::sql_parameter_list_type params = {
-		feed_url
-	};
-
-	sqlite3* db = nullptr;
-
-	ns_db::open_db (db_file_name, &db);
-
-	ns_db::sql_rowset_type rows;
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+	set_feed_retrieved (&db, feed_url);
 
-	ns_db::close_db (&db);
+	ns_db::release_writer (db_file_name);
 
 	return;
 }
@@ -543,13 +1641,9 @@ gautier_rss_data_write::update_rss_db_from_rss_xml (const std::string db_file_na
 
 	const std::string download_date = gautier_rss_util::get_current_date_time_utc();
 
-	for (ns_data_read::rss_article article : feed_lines) {
-		const bool article_good = ns_data_read::finalize_rss_article (feed_name, download_date, article);
+	finalize_feed_lines (feed_name, download_date, feed_lines);
 
-		if (article_good) {
-			gautier_rss_data_write::set_feed_headline (db_file_name, article);
-		}
-	}
+	set_feed_headlines (db_file_name, "", feed_lines);
 
 	return;
 }
@@ -628,8 +1722,6 @@ gautier_rss_data_write::update_rss_xml_db_from_network (const std::string db_fil
 		const bool response_good = ns_data_read::is_network_response_ok (response_code);
 
 		if (response_good) {
-			update_feed_retrieved (db_file_name, feed_url);
-
 			ns_parse::save_feed_data_to_file (feed_name, ".xml", feed_data);
 
 			ns_data_read::articles_list_type feed_lines;
@@ -638,13 +1730,9 @@ gautier_rss_data_write::update_rss_xml_db_from_network (const std::string db_fil
 
 			const std::string download_date = gautier_rss_util::get_current_date_time_utc();
 
-			for (ns_data_read::rss_article article : feed_lines) {
-				const bool article_good = ns_data_read::finalize_rss_article (feed_name, download_date, article);
+			finalize_feed_lines (feed_name, download_date, feed_lines);
 
-				if (article_good) {
-					gautier_rss_data_write::set_feed_headline (db_file_name, article);
-				}
-			}
+			set_feed_headlines (db_file_name, feed_url, feed_lines);
 		}
 	}
 
@@ -671,10 +1759,14 @@ gautier_rss_data_write::update_rss_db_from_network (const std::string db_file_na
 {
 	const int64_t rowid = ns_data_read::get_feed_article_max_row_id (db_file_name, feed_name);
 
+	std::vector<std::future<bool>> pending_writes;
+
 	const long response_code = update_rss_db_from_network_impl (db_file_name, feed_name, feed_url,
-	                           retrieve_limit_hrs, retention_days);
+	                           retrieve_limit_hrs, retention_days, pending_writes);
 
-	ns_data_read::get_feed_articles_after_row_id (db_file_name, feed_name, articles, true, rowid);
+	if (wait_for_feed_writes (feed_name, pending_writes)) {
+		ns_data_read::get_feed_articles_after_row_id (db_file_name, feed_name, articles, true, rowid);
+	}
 
 	return response_code;
 }
@@ -689,61 +1781,351 @@ gautier_rss_data_write::update_rss_db_from_network (const std::string db_file_na
 {
 	const int64_t rowid = ns_data_read::get_feed_article_max_row_id (db_file_name, feed_name);
 
+	std::vector<std::future<bool>> pending_writes;
+
 	const long response_code = update_rss_db_from_network_impl (db_file_name, feed_name, feed_url,
-	                           retrieve_limit_hrs, retention_days);
+	                           retrieve_limit_hrs, retention_days, pending_writes);
 
-	ns_data_read::get_feed_headlines_after_row_id (db_file_name, feed_name, headlines, true, rowid);
+	if (wait_for_feed_writes (feed_name, pending_writes)) {
+		ns_data_read::get_feed_headlines_after_row_id (db_file_name, feed_name, headlines, true, rowid);
+	}
 
 	return response_code;
 }
 
+void
+gautier_rss_data_write::start_write_queue (const std::string db_file_name,
+        const int64_t max_commit_delay_in_milliseconds)
+{
+	ns_db::start_write_queue (db_file_name, max_commit_delay_in_milliseconds, write_queue_batch_max);
+
+	return;
+}
+
+std::future<bool>
+gautier_rss_data_write::queue_feed_config (const std::string db_file_name,
+        const std::string feed_name,
+        const std::string feed_url,
+        const std::string retrieve_limit_hrs,
+        const std::string retention_days)
+{
+	return ns_db::queue_write (db_file_name, [feed_name, feed_url, retrieve_limit_hrs, retention_days] (sqlite3** db) {
+		return insert_feed_config (db, feed_name, feed_url, retrieve_limit_hrs, retention_days);
+	});
+}
+
+std::future<bool>
+gautier_rss_data_write::queue_feed_headlines (const std::string db_file_name, const std::string feed_url,
+        const ns_data_read::articles_list_type& articles)
+{
+	std::shared_ptr<ns_data_read::articles_list_type> queued_articles =
+	    std::make_shared<ns_data_read::articles_list_type> (articles);
+
+	return ns_db::queue_write (db_file_name, [feed_url, queued_articles] (sqlite3** db) {
+		return store_feed_headlines (db, feed_url, *queued_articles);
+	});
+}
+
+std::future<bool>
+gautier_rss_data_write::queue_feed_retrieved (const std::string db_file_name, const std::string feed_url)
+{
+	return ns_db::queue_write (db_file_name, [feed_url] (sqlite3** db) {
+		return set_feed_retrieved (db, feed_url);
+	});
+}
+
+void
+gautier_rss_data_write::set_article_compression (const bool enabled)
+{
+	article_compression_enabled = enabled;
+
+	return;
+}
+
+void
+gautier_rss_data_write::recompress_articles (const std::string db_file_name)
+{
+	int64_t max_row_id = 0;
+
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
+	{
+		ns_db::sql_cursor cursor;
+
+		ns_db::sql_parameter_list_type params;
+
+		if (ns_db::open_cursor (&db, "SELECT IFNULL(MAX(article_id), 0) FROM feeds_articles_body;", params, cursor)) {
+			if (ns_db::next_row (cursor)) {
+				max_row_id = ns_db::get_column_int64 (cursor, 0);
+			}
+
+			ns_db::close_cursor (cursor);
+		}
+	}
+	ns_db::release_writer (db_file_name);
+
+	/*
+		Only rows whose stored form changes are updated.
+		The plain text of a row is the same in either form, so the search index is left as it is.
+	*/
+	const std::string sql_text =
+	    "UPDATE 	feeds_articles_body SET \
+			article_summary = article_compress(article_summary), \
+			article_text = article_compress(article_text) \
+		WHERE 	article_id > @row_id_start AND article_id <= @row_id_end AND \
+			(article_summary IS NOT article_compress(article_summary) OR \
+			article_text IS NOT article_compress(article_text))";
+
+	/*
+		The writer is released between batches so downloads are not held up for long.
+	*/
+	const int64_t batch_size = 500;
+
+	for (int64_t row_id_start = 0; row_id_start < max_row_id; row_id_start += batch_size) {
+		ns_db::sql_parameter_list_type params = {
+			std::to_string (row_id_start),
+			std::to_string (row_id_start + batch_size)
+		};
+
+		db = ns_db::acquire_writer (db_file_name);
+
+		ns_db::process_sql (&db, sql_text, params);
+
+		ns_db::release_writer (db_file_name);
+	}
+
+	return;
+}
+
 void
 gautier_rss_data_write::remove_expired_articles (const std::string db_file_name)
 {
+	const std::atomic_bool stop_requested = false;
+
+	remove_expired_articles (db_file_name, stop_requested);
+
+	return;
+}
+
+void
+gautier_rss_data_write::remove_expired_articles (const std::string db_file_name,
+        const std::atomic_bool& stop_requested)
+{
+	/*
+		Feeds with a retention period and the insert time (epoch seconds) before which articles expire.
+		Articles inserted on or before the date retention_days ago are expired.
+	*/
+	const std::string feeds_sql_text =
+	    "SELECT \
+			feed_id, \
+			CAST(STRFTIME('%s', DATE('now', '-' || CAST(retention_days AS TEXT) || ' day'), '+1 day') AS INTEGER) \
+		FROM 	feeds \
+		WHERE 	retention_days > 0;";
+
+	std::vector<std::pair<int64_t, int64_t>> expirations;
+
+	sqlite3* db = ns_db::acquire_reader (db_file_name);
+	{
+		ns_db::sql_parameter_list_type params;
+
+		ns_db::sql_cursor cursor;
+
+		if (ns_db::open_cursor (&db, feeds_sql_text, params, cursor)) {
+			while (ns_db::next_row (cursor)) {
+				expirations.emplace_back (ns_db::get_column_int64 (cursor, 0), ns_db::get_column_int64 (cursor, 1));
+			}
+
+			ns_db::close_cursor (cursor);
+		}
+	}
+	ns_db::release_reader (db_file_name, db);
+
+	/*
+		Expired articles are found through the (feed_id, row_insert_epoch) index and deleted
+		a batch at a time. The writer is released between batches so other writes are not held up.
+		The search entries of a batch are removed in the same transaction, before its bodies are.
+
+		Both statements pick the same rows: same filter, same index order, same limit.
+		A feed is left for the next run when a batch cannot begin, delete or commit,
+		so a busy, full or read-only file does not select the same rows over and over.
+	*/
+	const std::string expired_sql_text =
+	    "SELECT \
+			fa.article_id, fa.headline_text, b.article_summary, b.article_text, \
+			b.article_id IS NOT NULL \
+		FROM  	feeds_articles AS fa LEFT OUTER JOIN \
+			feeds_articles_body AS b ON b.article_id = fa.article_id \
+		WHERE 	fa.feed_id = @feed_id AND \
+			fa.row_insert_epoch < @expiration_epoch \
+		ORDER BY fa.row_insert_epoch, fa.article_id \
+		LIMIT 	CAST(@batch_size AS INTEGER);";
+
 	const std::string sql_text =
 	    "DELETE FROM \
-		feeds_articles AS articles \
-		WHERE 	articles.ROWID IN ( \
+		feeds_articles \
+		WHERE 	article_id IN ( \
 			SELECT \
-				FA.ROWID \
-			FROM  	feeds AS F INNER JOIN \
-			feeds_articles AS FA ON F.feed_name = FA.feed_name \
-			WHERE 	F.retention_days > 0 AND \
-				DATE(FA.row_insert_date_time) <= \
-				DATE('now', '-' || CAST(F.retention_days AS TEXT) || ' day') \
+				article_id \
+			FROM 	feeds_articles \
+			WHERE 	feed_id = @feed_id AND \
+				row_insert_epoch < @expiration_epoch \
+			ORDER BY row_insert_epoch, article_id \
+			LIMIT 	CAST(@batch_size AS INTEGER) \
 		);";
 
-	ns_db::sql_parameter_list_type params;
+	const int64_t batch_size = 256;
 
-	sqlite3* db = nullptr;
+	for (const auto& [feed_id, expiration_epoch] : expirations) {
+		int64_t expired_count = batch_size;
 
-	ns_db::open_db (db_file_name, &db);
+		while (expired_count >= batch_size && stop_requested == false) {
+			ns_db::sql_parameter_list_type params = {
+				std::to_string (feed_id),
+				std::to_string (expiration_epoch),
+				std::to_string (batch_size)
+			};
 
-	ns_db::sql_rowset_type rows;
+			expired_count = 0;
 
-	ns_db::process_sql (&db, sql_text, params, rows);
+			bool committed = false;
 
-	ns_db::close_db (&db);
+			db = ns_db::acquire_writer (db_file_name);
+
+			const bool transaction_started = ns_db::begin_transaction (&db);
+
+			if (transaction_started) {
+				std::vector<article_search_entry> entries;
+
+				if (get_article_search_entries (&db, expired_sql_text, params, entries) &&
+				        set_article_search_entries (&db, entries, true) &&
+				        ns_db::process_sql (&db, sql_text, params)) {
+					expired_count = ns_db::get_changed_row_count (&db);
+				}
+
+				if (expired_count > 0) {
+					committed = ns_db::commit_transaction (&db, transaction_started);
+				} else {
+					ns_db::rollback_transaction (&db, transaction_started);
+				}
+			}
+
+			ns_db::release_writer (db_file_name);
+
+			if (committed == false) {
+				break;
+			}
+		}
+	}
 
 	return;
 }
 
+bool
+gautier_rss_data_write::perform_db_maintenance (const std::string db_file_name,
+        const int64_t time_budget_in_milliseconds)
+{
+	const std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now() +
+	        std::chrono::milliseconds (time_budget_in_milliseconds);
+
+	const auto time_remains = [&end_time]() {
+		return (std::chrono::steady_clock::now() < end_time);
+	};
+
+	/*
+		Return free pages to the file system a slice at a time.
+		The writer is released between slices so downloads are not held up.
+	*/
+	const std::string incremental_vacuum_sql_text = "PRAGMA incremental_vacuum(" +
+	        std::to_string (incremental_vacuum_page_count) + ");";
+
+	int64_t free_page_count = 0;
+
+	do {
+		sqlite3* db = ns_db::acquire_writer (db_file_name);
+		{
+			ns_db::sql_cursor cursor;
+
+			if (ns_db::open_cursor (&db, "PRAGMA freelist_count;", ns_db::sql_parameter_list_type(), cursor)) {
+				if (ns_db::next_row (cursor)) {
+					free_page_count = ns_db::get_column_int64 (cursor, 0);
+				}
+
+				ns_db::close_cursor (cursor);
+			}
+
+			if (free_page_count > 0) {
+				ns_db::process_sql_simple (&db, incremental_vacuum_sql_text);
+
+				free_page_count = std::max<int64_t> (0, free_page_count - incremental_vacuum_page_count);
+			}
+		}
+		ns_db::release_writer (db_file_name);
+	} while (free_page_count > 0 && time_remains());
+
+	if (free_page_count > 0) {
+		return false;
+	}
+
+	/*
+		Refresh query planner statistics. Only tables whose statistics are stale are analyzed.
+	*/
+	if (time_remains() == false) {
+		return false;
+	}
+
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
+
+	ns_db::process_sql_simple (&db, "PRAGMA optimize;");
+
+	ns_db::release_writer (db_file_name);
+
+	/*
+		Copy committed pages from the WAL into the database without waiting on readers.
+	*/
+	if (time_remains() == false) {
+		return false;
+	}
+
+	db = ns_db::acquire_writer (db_file_name);
+
+	ns_db::process_sql_simple (&db, "PRAGMA wal_checkpoint(PASSIVE);");
+
+	ns_db::release_writer (db_file_name);
+
+	return true;
+}
+
 void
-gautier_rss_data_write::de_initialize_db (const std::string db_file_name)
+gautier_rss_data_write::vacuum_db (const std::string db_file_name)
 {
-	if (db_file_name.empty() == false) {
-		const std::string sql_text = "VACUUM;";
+	sqlite3* db = ns_db::acquire_writer (db_file_name);
 
-		ns_db::sql_parameter_list_type params;
+	/*
+		A database created before auto_vacuum was set is converted by this VACUUM.
+	*/
+	ns_db::process_sql_simple (&db, "PRAGMA auto_vacuum = INCREMENTAL;");
 
-		sqlite3* db = nullptr;
-		ns_db::open_db (db_file_name, &db);
+	ns_db::process_sql_simple (&db, "VACUUM;");
 
-		ns_db::sql_rowset_type rows;
+	ns_db::process_sql_simple (&db, "PRAGMA wal_checkpoint(TRUNCATE);");
+
+	ns_db::release_writer (db_file_name);
+
+	return;
+}
 
-		ns_db::process_sql (&db, sql_text, params, rows);
+void
+gautier_rss_data_write::de_initialize_db (const std::string db_file_name)
+{
+	if (db_file_name.empty() == false) {
+		/*
+			Finish queued writes before the connections close.
+		*/
+		ns_db::stop_write_queue (db_file_name);
 
-		ns_db::close_db (&db);
+		/*
+			Release the session held since initialize_db.
+		*/
+		ns_db::close_session (db_file_name);
 	}
 
 	ns_data_read::de_initialize_network();
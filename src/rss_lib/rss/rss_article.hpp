@@ -13,6 +13,7 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #ifndef michael_gautier_rss_data_read_article_h
 #define michael_gautier_rss_data_read_article_h
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -26,6 +27,9 @@ namespace gautier_rss_data_read {
 			std::string article_summary;
 			std::string article_text;
 			std::string url;
+
+			/*Publication date in epoch seconds (UTC). Set on articles read from the database.*/
+			int64_t article_date_epoch = 0;
 	};
 
 	bool
@@ -58,6 +58,10 @@ namespace gautier_rss_data_read {
 	is_feed_still_fresh (const std::string db_file_name, const std::string feed_name,
 	                     const bool time_message_stdout);
 
+	//Same check for a feed already read from the database.
+	bool
+	is_feed_still_fresh (const rss_feed& feed, const bool time_message_stdout);
+
 	void
 	copy_feed (rss_feed* feed_in, rss_feed* feed_out);
 
@@ -36,31 +36,69 @@ namespace gautier_rss_data_read {
 	int64_t
 	get_feed_article_max_row_id (const std::string db_file_name, const std::string feed_name);
 
+	int64_t
+	get_feed_article_max_row_id (const std::string db_file_name, const int64_t feed_id);
+
 	void
 	get_feed_articles_after_row_id (const std::string db_file_name, const std::string feed_name,
 	                                articles_list_type& headlines, const bool descending, const int64_t row_id);
 
+	void
+	get_feed_articles_after_row_id (const std::string db_file_name, const int64_t feed_id,
+	                                articles_list_type& headlines, const bool descending, const int64_t row_id);
+
 	void
 	get_feed_articles (const std::string db_file_name, const std::string feed_name, articles_list_type& headlines,
 	                   const bool descending);
 
+	void
+	get_feed_articles (const std::string db_file_name, const int64_t feed_id, articles_list_type& headlines,
+	                   const bool descending);
+
+	/*
+		Articles published within [from_epoch_seconds, to_epoch_seconds], read through the
+		feed_id + article_date_epoch index.
+	*/
+	void
+	get_feed_articles_by_date (const std::string db_file_name, const int64_t feed_id,
+	                           const int64_t from_epoch_seconds, const int64_t to_epoch_seconds,
+	                           articles_list_type& articles, const bool descending);
+
 	void
 	get_feed_article_summary (const std::string db_file_name, const std::string feed_name,
 	                          const std::string headline, rss_article& article);
 
+	void
+	get_feed_article_summary (const std::string db_file_name, const int64_t feed_id,
+	                          const std::string headline, rss_article& article);
+
 	void
 	get_feed_by_row_id (const std::string db_file_name, const int64_t row_id, rss_feed& feed);
 
 	void
 	get_feed (const std::string db_file_name, const std::string feed_name, rss_feed& feed);
 
+	/*
+		Feeds are keyed by feed_id (rss_feed::row_id).
+		Functions taking a feed name look up the id and call the feed_id version.
+	*/
+	int64_t
+	get_feed_id (const std::string db_file_name, const std::string feed_name);
+
 	int64_t
 	get_feed_headline_count (const std::string db_file_name, const std::string feed_name);
 
+	int64_t
+	get_feed_headline_count (const std::string db_file_name, const int64_t feed_id);
+
 	void
 	get_feed_headlines_after_row_id (const std::string db_file_name, const std::string feed_name,
 	                                 headlines_list_type& headlines, const bool descending, const int64_t row_id);
 
+	void
+	get_feed_headlines_after_row_id (const std::string db_file_name, const int64_t feed_id,
+	                                 headlines_list_type& headlines, const bool descending, const int64_t row_id);
+
 	void
 	get_feed_headlines_by_range (const std::string db_file_name, const std::string feed_name,
 	                             headlines_list_type& headlines, const bool descending, const headline_range_type range);
@@ -69,6 +107,10 @@ namespace gautier_rss_data_read {
 	get_feed_headlines (const std::string db_file_name, const std::string feed_name, headlines_list_type& headlines,
 	                    const bool descending);
 
+	void
+	get_feed_headlines (const std::string db_file_name, const int64_t feed_id, headlines_list_type& headlines,
+	                    const bool descending);
+
 	void
 	get_feeds (const std::string db_file_name, feeds_list_type& feeds);
 
@@ -78,5 +120,16 @@ namespace gautier_rss_data_read {
 	bool
 	headline_range_valid (const headline_range_type& range);
 
+	/*
+		FULL TEXT SEARCH
+
+		Finds articles whose headline, summary or text contain every word in search_text.
+		The last word also matches as a prefix. Best matches come first, headline matches
+		weighing the most. offset and limit select one page of the results.
+	*/
+	void
+	search_articles (const std::string db_file_name, const std::string search_text, const int64_t offset,
+	                 const int64_t limit, articles_list_type& articles);
+
 }
 #endif
@@ -14,6 +14,7 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #define michael_gautier_rss_util_source_h
 
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <charconv>
 
@@ -28,9 +29,62 @@ namespace gautier_rss_util {
 	int_fast32_t
 	get_time_difference_in_seconds (const std::string date1, const std::string date2);
 
+	/*
+		DATE/TIME
+
+		Converts between epoch seconds and the UTC "YYYY-MM-DD HH:MM:SS" text SQLite uses.
+		Neither function allocates beyond the output string.
+	*/
+	bool
+	parse_date_time (std::string_view text, int64_t& epoch_seconds);
+
+	void
+	format_date_time (const int64_t epoch_seconds, std::string& text);
+
+	int64_t
+	get_current_epoch_seconds();
+
+	/*
+		Reads a feed entry publication date (RFC 822/1123, RFC 850, RFC 3339/ISO 8601,
+		asctime and common variations) into epoch seconds. Does not allocate.
+	*/
+	bool
+	parse_publication_date (std::string_view text, int64_t& epoch_seconds);
+
+	/*
+		TEXT
+
+		ASCII text helpers on string_view. SSE2/AVX2 on x86 with a char at a time fallback.
+		Output strings are overwritten so one string can be reused across calls.
+	*/
+	void
+	convert_to_lower_case (std::string_view text, std::string& lower_case_text);
+
+	void
+	copy_digits (std::string_view text, std::string& digits);
+
+	std::string_view
+	trim_white_space (std::string_view text);
+
+	bool
+	equals_ignore_case (std::string_view text1, std::string_view text2);
+
 	void
 	convert_chars_to_lower_case_string (const char* chars, std::string& str);
 
+	void
+	convert_markup_to_plain_text (std::string_view text, std::string& plain_text);
+
+	bool
+	compress_text (std::string_view text, std::string& compressed);
+
+	bool
+	decompress_text (std::string_view compressed, std::string& text);
+
+	int64_t
+	get_article_fingerprint (const std::string& feed_key, const std::string& headline,
+	                         const std::string& article_url);
+
 	bool
 	convert_chars_to_string (const char* chars, std::string& str);
 
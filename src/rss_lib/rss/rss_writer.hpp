@@ -13,7 +13,9 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #ifndef michael_gautier_rss_data_write_api_h
 #define michael_gautier_rss_data_write_api_h
 
+#include <atomic>
 #include <cstdint>
+#include <future>
 #include <map>
 #include <string>
 #include <vector>
@@ -33,8 +35,8 @@ namespace gautier_rss_data_write {
 		Manages the database schema.
 		Creates any tables needed.
 
-		This function does not keep the database open.
-		All it does is initialize the database.
+		This function keeps the database open in a session
+		that lasts until de_initialize_db is called.
 
 		You only need to call it once at the start of a program.
 		Call it once near the start of a program before any other
@@ -59,6 +61,7 @@ namespace gautier_rss_data_write {
 		RSS FEED CONFIGURATION
 
 		Updates an RSS feed configuration.
+		row_id is the feed_id. Articles follow a renamed feed through feed_id.
 	*/
 	void
 	update_feed_config (const std::string db_file_name,
@@ -71,7 +74,9 @@ namespace gautier_rss_data_write {
 	/*
 		RSS FEED CONFIGURATION - PART III
 
-		Fixes links to the feed configuration.
+		Renames a feed.
+
+		Articles reference the feed by feed_id so only the feed row changes.
 	*/
 	void
 	update_feed_config_related (const std::string db_file_name, const std::string feed_name_old,
@@ -96,18 +101,34 @@ namespace gautier_rss_data_write {
 		That does not mean it is the primary key from a data management
 		standpoint but that it can be used to reliably remove all related
 		information.
+
+		Articles are removed with the feed (ON DELETE CASCADE on feed_id).
 	*/
 	void
 	delete_feed (const std::string db_file_name, const std::string feed_url);
 
+	void
+	delete_feed (const std::string db_file_name, const int64_t feed_id);
+
 	/*
 		RSS HEADLINE/ARTICLE
 
 		Stores an individual line from an RSS feed.
+		The feed named by article.feed_name must already be configured.
 	*/
 	void
 	set_feed_headline (const std::string db_file_name, gautier_rss_data_read::rss_article& article);
 
+	/*
+		RSS HEADLINES/ARTICLES
+
+		Stores all lines from one download of an RSS feed in a single transaction.
+		When feed_url is not empty, the feed's last_retrieved date is set in the same transaction.
+	*/
+	void
+	set_feed_headlines (const std::string db_file_name, const std::string feed_url,
+	                    gautier_rss_data_read::articles_list_type& articles);
+
 	/*
 		Primary RSS function.
 
@@ -233,9 +254,94 @@ namespace gautier_rss_data_write {
 	                            const std::string retention_days,
 	                            gautier_rss_data_read::articles_list_type& articles);
 
+	/*
+		RSS ARTICLE RETENTION
+
+		Deletes articles older than the retention_days of their feed.
+		Works a feed at a time in small batches, each in its own short transaction.
+
+		The second form checks stop_requested between batches so a background
+		caller can end it early. The remaining articles are removed on a later run.
+		A feed whose batch fails (busy, full or read-only file) is also left for a later run.
+	*/
 	void
 	remove_expired_articles (const std::string db_file_name);
 
+	void
+	remove_expired_articles (const std::string db_file_name, const std::atomic_bool& stop_requested);
+
+	/*
+		ARTICLE COMPRESSION
+
+		Article summary and text of a few hundred bytes or more are stored zlib compressed
+		when that saves space. Readers expand them only when the text is requested.
+		The setting applies to rows written after it changes. On by default.
+	*/
+	void
+	set_article_compression (const bool enabled);
+
+	/*
+		Rewrites stored article summary and text with the current compression setting.
+		Runs in batches of rows, each in its own short transaction.
+	*/
+	void
+	recompress_articles (const std::string db_file_name);
+
+	/*
+		WRITE QUEUE
+
+		Starts a thread that commits queued writes in the background. Writes queued
+		within max_commit_delay_in_milliseconds of each other share one transaction.
+		Call after initialize_db. de_initialize_db finishes the queued writes and stops the thread.
+
+		The queue_ functions return right away. Their future becomes ready once the
+		write is committed (true) or the write or its transaction failed (false). A failed
+		write is rolled back whole. Without a started queue they write on the calling
+		thread before returning.
+
+		update_rss_feeds and update_rss_db_from_network write through the queue.
+		They return no new articles for a feed whose writes failed.
+	*/
+	void
+	start_write_queue (const std::string db_file_name, const int64_t max_commit_delay_in_milliseconds);
+
+	std::future<bool>
+	queue_feed_config (const std::string db_file_name,
+	                   const std::string feed_name,
+	                   const std::string feed_url,
+	                   const std::string retrieve_limit_hrs,
+	                   const std::string retention_days);
+
+	std::future<bool>
+	queue_feed_headlines (const std::string db_file_name, const std::string feed_url,
+	                      const gautier_rss_data_read::articles_list_type& articles);
+
+	std::future<bool>
+	queue_feed_retrieved (const std::string db_file_name, const std::string feed_url);
+
+	/*
+		DATABASE MAINTENANCE
+
+		Runs a slice of routine upkeep: incremental_vacuum of free pages,
+		PRAGMA optimize and a passive WAL checkpoint. Stops once the time
+		budget is spent. Call it when the program is otherwise idle.
+
+		Returns true when every step finished. Returns false when work remains
+		for the next call.
+	*/
+	bool
+	perform_db_maintenance (const std::string db_file_name, const int64_t time_budget_in_milliseconds);
+
+	/*
+		Rebuilds the whole database file with VACUUM. Takes time in proportion to the
+		size of the database. Only run on request, never as part of a routine exit.
+	*/
+	void
+	vacuum_db (const std::string db_file_name);
+
+	/*
+		Closes the database session opened by initialize_db.
+	*/
 	void
 	de_initialize_db (const std::string db_file_name);
 }
@@ -13,7 +13,9 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #ifndef michael_gautier_rss_download_h
 #define michael_gautier_rss_download_h
 
+#include <functional>
 #include <string>
+#include <string_view>
 
 namespace gautier_rss_data_read {
 	void
@@ -27,6 +29,16 @@ namespace gautier_rss_data_read {
 	long
 	download_rss_feed (const std::string feed_url, std::string& headlines);
 
+	/*
+		Hands each block of the response to receive_data as it arrives. Nothing is buffered.
+		receive_data returns false to end the transfer.
+		Returns -1 when the transfer did not complete.
+	*/
+	using download_data_function_type = std::function<bool (std::string_view data)>;
+
+	long
+	download_rss_feed (const std::string feed_url, const download_data_function_type& receive_data);
+
 	bool
 	is_network_response_ok (const long response_code);
 
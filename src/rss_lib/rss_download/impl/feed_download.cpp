@@ -19,6 +19,7 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <cwchar>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 #include <curl/curl.h>
 
@@ -33,36 +34,18 @@ extern "C" {
 		   https://ec.haxx.se/libcurlexamples.html
 		   https://ec.haxx.se/libcurl-http-requests.html
 	*/
-	struct MemoryStruct
-	{
-		char* memory;
-		size_t size;
-	};
-
 	static size_t
-	WriteMemoryCallback (void* contents, const size_t size, const size_t nmemb, void* userp)
+	WriteFunctionCallback (void* contents, const size_t size, const size_t nmemb, void* userp)
 	{
-		size_t realsize = size * nmemb;
-
-		struct MemoryStruct* mem = (struct MemoryStruct*)userp;
+		const size_t realsize = size * nmemb;
 
-		mem->memory = (char*)realloc (mem->memory, mem->size + realsize + 1);
+		const gautier_rss_data_read::download_data_function_type* receive_data =
+		    (const gautier_rss_data_read::download_data_function_type*)userp;
 
-		/*May indicate out of memory.*/
-		bool is_bad_memory_allocation = (mem->memory == nullptr);
-
-		if (is_bad_memory_allocation) {
-			std::cout << __FILE__ << " in " << __func__ << " at line: " << __LINE__ << "\n";
-			std::cout << "Bad memory allocation. Possibly out of memory.\n";
-
-			realsize = 0;
-		} else {
-			memcpy (& (mem->memory[mem->size]), contents, realsize);
-			mem->size += realsize;
-			mem->memory[mem->size] = 0;
-		}
+		const bool is_data_accepted = (*receive_data) (std::string_view ((const char*)contents, realsize));
 
-		return realsize;
+		/*Any other value than realsize stops the transfer.*/
+		return is_data_accepted ? realsize : 0;
 	}
 }
 
@@ -75,6 +58,107 @@ namespace {
 
 	const long
 	http_response_max_good = 399;
+
+	/*
+		transfer_result is CURLE_OK when the whole response was received.
+	*/
+	long
+	perform_download (const std::string& feed_url, const gautier_rss_data_read::download_data_function_type& receive_data,
+	                  CURLcode& transfer_result)
+	{
+		long response_code = 0L;
+
+		/*HTTP Request*/
+		CURL* curl_client = curl_easy_init();
+
+		if (curl_client) {
+			/*
+				CURL setup.
+
+				ALWAYS KEEP THE VERBOSITY LEVEL SET ON.
+				Good to have response codes but they are for program control flow.
+				The verbose messages are far better for diagnostic and optimization purposes.
+			*/
+			curl_easy_setopt (curl_client, CURLOPT_VERBOSE, 1L);//1 = true; show everything
+			curl_easy_setopt (curl_client, CURLOPT_NOPROGRESS, 1L);//1 = true; except don't show progress text
+
+			/*Connection durations*/
+			curl_easy_setopt (curl_client, CURLOPT_DNS_CACHE_TIMEOUT, 120L);//2 minutes to cache DNS
+			curl_easy_setopt (curl_client, CURLOPT_CONNECTTIMEOUT, 54L);//54 seconds max wait time for a connection
+			curl_easy_setopt (curl_client, CURLOPT_TCP_KEEPALIVE, 1L);//1 = true; enable Keep Alive
+
+			/*Protocol configuration*/
+			curl_easy_setopt (curl_client, CURLOPT_HTTP_VERSION, http_version);//Request HTTP2 connections with TLS
+			curl_easy_setopt (curl_client, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);//Prefer IPv4
+			curl_easy_setopt (curl_client, CURLOPT_HTTPGET, 1L);//1 = true; prefer GET requests
+
+			/*URL and response handling*/
+			curl_easy_setopt (curl_client, CURLOPT_MAXREDIRS,
+			                  4L);//Up to 4 redirects; even 1 redirect hints at possibly wrong url
+			curl_easy_setopt (curl_client, CURLOPT_URL, feed_url.data());//Connect to this URL
+
+			/*
+				CURL DOC: Send all data to this function.
+
+				Register the callback function that will receive the data from http.
+			*/
+			curl_easy_setopt (curl_client, CURLOPT_WRITEFUNCTION, WriteFunctionCallback);
+
+			/*
+				CURL DOC: Pass the 'receive_data' function to the callback function.
+
+				Each block received is handed to receive_data.
+			*/
+			curl_easy_setopt (curl_client, CURLOPT_WRITEDATA, (void*)&receive_data);
+
+			/*
+				Some servers reject requests lacking a proper user-agent.
+
+				The following user agent comes from these sources:
+					Firefox Developer Tools
+					Mozilla website
+				This is the most acceptable generic version for now. Standards on user agents change over time.
+			*/
+			curl_easy_setopt (curl_client, CURLOPT_USERAGENT,
+			                  "Mozilla/5.0 (X11; Linux x86_64; rv:10.0) Gecko/20100101 Firefox/10.0");
+
+			/*
+				HTTP header.
+			*/
+			struct curl_slist* curl_http_header = nullptr;
+			curl_http_header = curl_slist_append (curl_http_header, "Accept: application/xhtml+xml, application/xml");
+			curl_http_header = curl_slist_append (curl_http_header, "Cache-Control: max-age=0");
+			curl_http_header = curl_slist_append (curl_http_header, "Robots: off");
+
+			curl_easy_setopt (curl_client, CURLOPT_HTTPHEADER, curl_http_header);
+
+			/*
+				DOWNLOAD the web page in xml format.
+			*/
+			CURLcode curl_response = curl_easy_perform (curl_client);
+
+			/*
+				Verify response back is usable.
+			*/
+			transfer_result = curl_response;
+
+			curl_response = curl_easy_getinfo (curl_client, CURLINFO_RESPONSE_CODE, &response_code);
+
+			if (curl_response != CURLE_OK) {
+				response_code = -1;
+			}
+
+			/*
+				Clean up
+			*/
+			curl_slist_free_all (curl_http_header);
+			curl_easy_cleanup (curl_client);
+		}
+
+		curl_client = nullptr;
+
+		return response_code;
+	}
 }
 
 void
@@ -89,106 +173,34 @@ gautier_rss_data_read::initialize_network()
 long
 gautier_rss_data_read::download_rss_feed (const std::string feed_url, std::string& headlines)
 {
-	long response_code = 0L;
-
-	/*HTTP Request*/
-	CURL* curl_client = curl_easy_init();
-
-	if (curl_client) {
-		struct MemoryStruct chunk;
-		chunk.memory = (char*)malloc (1);
-		chunk.size = 0;
-
-		/*
-			CURL setup.
-
-			ALWAYS KEEP THE VERBOSITY LEVEL SET ON.
-			Good to have response codes but they are for program control flow.
-			The verbose messages are far better for diagnostic and optimization purposes.
-		*/
-		curl_easy_setopt (curl_client, CURLOPT_VERBOSE, 1L);//1 = true; show everything
-		curl_easy_setopt (curl_client, CURLOPT_NOPROGRESS, 1L);//1 = true; except don't show progress text
-
-		/*Connection durations*/
-		curl_easy_setopt (curl_client, CURLOPT_DNS_CACHE_TIMEOUT, 120L);//2 minutes to cache DNS
-		curl_easy_setopt (curl_client, CURLOPT_CONNECTTIMEOUT, 54L);//54 seconds max wait time for a connection
-		curl_easy_setopt (curl_client, CURLOPT_TCP_KEEPALIVE, 1L);//1 = true; enable Keep Alive
-
-		/*Protocol configuration*/
-		curl_easy_setopt (curl_client, CURLOPT_HTTP_VERSION, http_version);//Request HTTP2 connections with TLS
-		curl_easy_setopt (curl_client, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);//Prefer IPv4
-		curl_easy_setopt (curl_client, CURLOPT_HTTPGET, 1L);//1 = true; prefer GET requests
-
-		/*URL and response handling*/
-		curl_easy_setopt (curl_client, CURLOPT_MAXREDIRS,
-		                  4L);//Up to 4 redirects; even 1 redirect hints at possibly wrong url
-		curl_easy_setopt (curl_client, CURLOPT_URL, feed_url.data());//Connect to this URL
-
-		/*
-			CURL DOC: Send all data to this function.
-
-			Register the callback function that will be used to assemble data from http.
-		*/
-		curl_easy_setopt (curl_client, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
-
-		/*
-			CURL DOC: Pass the 'chunk' struct to the callback function.
-
-			Associate the chunk reference to the callback function.
-		*/
-		curl_easy_setopt (curl_client, CURLOPT_WRITEDATA, (void*)&chunk);
-
-		/*
-			Some servers reject requests lacking a proper user-agent.
-
-			The following user agent comes from these sources:
-				Firefox Developer Tools
-				Mozilla website
-			This is the most acceptable generic version for now. Standards on user agents change over time.
-		*/
-		curl_easy_setopt (curl_client, CURLOPT_USERAGENT,
-		                  "Mozilla/5.0 (X11; Linux x86_64; rv:10.0) Gecko/20100101 Firefox/10.0");
-
-		/*
-			HTTP header.
-		*/
-		struct curl_slist* curl_http_header = nullptr;
-		curl_http_header = curl_slist_append (curl_http_header, "Accept: application/xhtml+xml, application/xml");
-		curl_http_header = curl_slist_append (curl_http_header, "Cache-Control: max-age=0");
-		curl_http_header = curl_slist_append (curl_http_header, "Robots: off");
-
-		curl_easy_setopt (curl_client, CURLOPT_HTTPHEADER, curl_http_header);
-
-		/*
-			DOWNLOAD the web page in xml format.
-		*/
-		CURLcode curl_response = curl_easy_perform (curl_client);
-
-		/*
-			Verify response back is usable.
-		*/
-		if (curl_response == CURLE_OK) {
-			std::string response_data (chunk.memory);
-
-			headlines = response_data;
-		}
+	std::string response_data;
 
-		curl_response = curl_easy_getinfo (curl_client, CURLINFO_RESPONSE_CODE, &response_code);
+	CURLcode transfer_result = CURLE_OK;
 
-		if (curl_response != CURLE_OK) {
-			response_code = -1;
-		}
+	const long response_code = perform_download (feed_url, [&response_data] (std::string_view data) {
+		response_data.append (data);
 
-		/*
-			Clean up
-		*/
-		curl_slist_free_all (curl_http_header);
-		curl_easy_cleanup (curl_client);
+		return true;
+	}, transfer_result);
 
-		free (chunk.memory);
+	if (transfer_result == CURLE_OK) {
+		headlines = std::move (response_data);
 	}
 
-	curl_client = nullptr;
+	return response_code;
+}
+
+long
+gautier_rss_data_read::download_rss_feed (const std::string feed_url, const download_data_function_type& receive_data)
+{
+	CURLcode transfer_result = CURLE_OK;
+
+	long response_code = perform_download (feed_url, receive_data, transfer_result);
+
+	/*receive_data has only seen part of the response.*/
+	if (transfer_result != CURLE_OK) {
+		response_code = -1;
+	}
 
 	return response_code;
 }
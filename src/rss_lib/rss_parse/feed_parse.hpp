@@ -20,9 +20,64 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include "rss_lib/rss/rss_article.hpp"
 
 namespace gautier_rss_data_parse {
+	/*
+		document:	Builds the whole libxml2 tree, then walks it.
+		stream:		Reads the feed with SAX2 callbacks and builds no tree. Each article is complete
+				when its item/entry element closes. Memory is bounded by the largest single item.
+	*/
+	enum class
+	feed_parse_mode
+	{
+		document,
+		stream
+	};
+
+	/*Parses in stream mode.*/
 	void
 	get_feed_lines (std::string_view feed_data, std::vector<gautier_rss_data_read::rss_article>& feed_lines);
 
+	void
+	get_feed_lines (std::string_view feed_data, std::vector<gautier_rss_data_read::rss_article>& feed_lines,
+	                const feed_parse_mode parse_mode);
+
+	/*
+		STREAMING PARSE SESSION
+
+		Stream mode parsing of text that arrives in pieces, such as a network download.
+		Articles are added to feed_lines as they are read. close_feed_parse_stream completes the parse.
+	*/
+	struct feed_parse_stream_state;
+
+	struct feed_parse_stream
+	{
+		public:
+			feed_parse_stream_state* state = nullptr;
+	};
+
+	bool
+	open_feed_parse_stream (std::vector<gautier_rss_data_read::rss_article>& feed_lines,
+	                        feed_parse_stream& parse_stream);
+
+	bool
+	write_feed_parse_stream (feed_parse_stream& parse_stream, std::string_view feed_data);
+
+	void
+	close_feed_parse_stream (feed_parse_stream& parse_stream);
+
+	/*
+		PARALLEL PARSE
+
+		Parses each entry of feed_data into the same entry of feed_lines on worker_count threads.
+		A worker_count of 0 uses one thread per core.
+
+		Every parse function can be called from any thread. libxml2 is set up on first use
+		and each thread keeps its own parser contexts.
+	*/
+	void
+	parse_many_feeds (const std::vector<std::string_view>& feed_data,
+	                  std::vector<std::vector<gautier_rss_data_read::rss_article>>& feed_lines,
+	                  const feed_parse_mode parse_mode, size_t worker_count);
+
 	void
 	save_feed_data_to_file (const std::string file_name, const std::string ext, std::string_view file_data);
 
@@ -10,9 +10,12 @@ You should have received a copy of the GNU Lesser General Public License along w
 Author: Michael Gautier <michaelgautier.wordpress.com>
 */
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstddef>
 #include <cstdio>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
@@ -20,9 +23,10 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <cwchar>
 #include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "libxml/parser.h"
@@ -32,13 +36,231 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include "rss_lib/rss/rss_util.hpp"
 
 namespace {
+	/*
+		ARTICLE FIELDS
+
+		Both parse modes follow the same rules so they produce the same articles:
+			An item or entry element starts a new article.
+			A recognized element is read as the text of its whole subtree and stored in the current article.
+			A link element without text takes its href attribute.
+
+		Element names are matched without regard to case. SAX2 passes the local name. The document tree keeps
+		the qualified name (dc:date) when its prefix is not declared, so both forms are listed.
+	*/
+	enum class
+	article_field
+	{
+		none,
+		article,
+		headline,
+		url,
+		article_date,
+		article_summary,
+		article_text
+	};
+
+	struct field_capture
+	{
+		public:
+			article_field field = article_field::none;
+			size_t article_index = 0;
+			int depth = 0;
+			std::string text;
+			std::string href;
+	};
+
+	const size_t
+	no_article = SIZE_MAX;
+
+	article_field
+	get_article_field (const char* node_name);
+
+	void
+	store_field_capture (field_capture& capture, gautier_rss_data_read::rss_article& article);
+
 	void
 	parse_rss_feed (xmlNode* parent_xml_node, std::vector<gautier_rss_data_read::rss_article>& feed_lines,
-	                gautier_rss_data_read::rss_article* previous_article);
+	                size_t article_index);
+
+	void
+	append_node_text (xmlNode* xml_node, std::string& text);
 
 	void
 	get_xml_attr_value (xmlNode* xml_node, std::string_view attr_name, std::string& value);
 
+	/*
+		ELEMENT NAME TABLE
+
+		Perfect hash over the recognized element names. The seed is searched for at compile time
+		so every name has its own slot. A name is hashed and measured in one pass, then compared
+		against the single name in its slot. Nothing is allocated or lower cased.
+	*/
+	struct element_name
+	{
+		public:
+			std::string_view name;
+			article_field field;
+	};
+
+	constexpr element_name
+	element_names[] = {
+		{"item", article_field::article}, {"entry", article_field::article}, {"atom:entry", article_field::article},
+		{"title", article_field::headline}, {"atom:title", article_field::headline}, {"dc:title", article_field::headline},
+		{"link", article_field::url}, {"atom:link", article_field::url},
+		{"pubdate", article_field::article_date}, {"published", article_field::article_date},
+		{"updated", article_field::article_date}, {"date", article_field::article_date},
+		{"atom:published", article_field::article_date}, {"atom:updated", article_field::article_date},
+		{"dc:date", article_field::article_date},
+		{"description", article_field::article_summary}, {"summary", article_field::article_summary},
+		{"atom:summary", article_field::article_summary}, {"dc:description", article_field::article_summary},
+		{"content", article_field::article_text}, {"encoded", article_field::article_text},
+		{"atom:content", article_field::article_text}, {"content:encoded", article_field::article_text}
+	};
+
+	constexpr size_t
+	element_name_count = sizeof (element_names) / sizeof (element_names[0]);
+
+	constexpr uint32_t
+	element_slot_bits = 6;
+
+	constexpr size_t
+	element_slot_count = (size_t) (1) << element_slot_bits;
+
+	constexpr uint32_t
+	fnv_prime = 16777619u;
+
+	/*
+		FNV-1a over the ASCII case folded chars. OR-ing 0x20 folds letters and leaves ':' and '-' alone.
+		The slot is taken from the high bits, which depend on every char.
+	*/
+	constexpr uint32_t
+	hash_element_name (std::string_view name, const uint32_t seed)
+	{
+		uint32_t hash = seed;
+
+		for (const char c : name) {
+			hash = (hash ^ (uint8_t) (c | 0x20)) * fnv_prime;
+		}
+
+		return hash;
+	}
+
+	constexpr size_t
+	get_element_slot (const uint32_t hash)
+	{
+		return hash >> (32 - element_slot_bits);
+	}
+
+	constexpr bool
+	is_perfect_hash_seed (const uint32_t seed)
+	{
+		bool is_slot_used[element_slot_count] = {};
+
+		for (const element_name& entry : element_names) {
+			const size_t slot = get_element_slot (hash_element_name (entry.name, seed));
+
+			if (is_slot_used[slot]) {
+				return false;
+			}
+
+			is_slot_used[slot] = true;
+		}
+
+		return true;
+	}
+
+	constexpr uint32_t
+	find_perfect_hash_seed()
+	{
+		uint32_t seed = 2166136261u;
+
+		while (is_perfect_hash_seed (seed) == false) {
+			seed++;
+		}
+
+		return seed;
+	}
+
+	constexpr uint32_t
+	element_hash_seed = find_perfect_hash_seed();
+
+	struct element_slot_table
+	{
+		public:
+			element_name slots[element_slot_count] = {};
+	};
+
+	constexpr element_slot_table
+	make_element_slot_table()
+	{
+		element_slot_table table;
+
+		for (const element_name& entry : element_names) {
+			table.slots[get_element_slot (hash_element_name (entry.name, element_hash_seed))] = entry;
+		}
+
+		return table;
+	}
+
+	constexpr element_slot_table
+	element_slots = make_element_slot_table();
+
+	static_assert (element_name_count <= element_slot_count, "element slot table is too small");
+
+	article_field
+	get_article_field (const char* node_name)
+	{
+		uint32_t hash = element_hash_seed;
+		size_t char_count = 0;
+
+		for (; node_name[char_count] != '\0'; char_count++) {
+			hash = (hash ^ (uint8_t) (node_name[char_count] | 0x20)) * fnv_prime;
+		}
+
+		const element_name& entry = element_slots.slots[get_element_slot (hash)];
+
+		article_field field = article_field::none;
+
+		if (entry.name.size() == char_count &&
+		        gautier_rss_util::equals_ignore_case (std::string_view (node_name, char_count), entry.name)) {
+			field = entry.field;
+		}
+
+		return field;
+	}
+
+	void
+	store_field_capture (field_capture& capture, gautier_rss_data_read::rss_article& article)
+	{
+		switch (capture.field) {
+			case article_field::headline:
+				article.headline = std::move (capture.text);
+				break;
+
+			case article_field::url:
+				article.url = capture.text.empty() ? std::move (capture.href) : std::move (capture.text);
+				break;
+
+			case article_field::article_date:
+				article.article_date = std::move (capture.text);
+				break;
+
+			case article_field::article_summary:
+				article.article_summary = std::move (capture.text);
+				break;
+
+			case article_field::article_text:
+				article.article_text.append (capture.text);
+				break;
+
+			case article_field::none:
+			case article_field::article:
+				break;
+		}
+
+		return;
+	}
+
 	/*
 
 		PRIMARY CODE
@@ -49,68 +271,78 @@ namespace {
 
 			The parse does not validate RSS/ATOM schema and takes a simpler approach
 				based on the element sequence expected in RSS/ATOM documents.
+
+			Only recognized elements have their text read so every text node is copied
+				once per recognized element that contains it.
 	*/
 	void
 	parse_rss_feed (xmlNode* parent_xml_node, std::vector<gautier_rss_data_read::rss_article>& feed_lines,
-	                gautier_rss_data_read::rss_article* previous_article)
+	                size_t article_index)
 	{
-		xmlNode* xml_node = nullptr;
-
-		gautier_rss_data_read::rss_article* article = previous_article;
-
-		for (xml_node = parent_xml_node; xml_node; xml_node = xml_node->next) {
+		for (xmlNode* xml_node = parent_xml_node; xml_node; xml_node = xml_node->next) {
 			if (xml_node->type != XML_ELEMENT_NODE) {
 				continue;
 			}
 
-			std::string node_name;
+			const article_field field = get_article_field ((const char*) (xml_node->name));
 
-			std::string xml_value;
-			{
-				std::stringstream xml_text;
+			if (field == article_field::article) {
+				feed_lines.emplace_back (gautier_rss_data_read::rss_article());
 
-				xml_text << xml_node->name;
+				article_index = feed_lines.size() - 1;
+			} else if (field != article_field::none && article_index != no_article) {
+				field_capture capture;
 
-				xml_value = xml_text.str();
-			}
+				capture.field = field;
 
-			gautier_rss_util::convert_chars_to_lower_case_string (xml_value.data(), node_name);
+				append_node_text (xml_node->children, capture.text);
 
-			if (node_name == "item" || node_name == "entry") {
-				feed_lines.emplace_back (gautier_rss_data_read::rss_article());
+				//Some feed formats use an href attribute for the link
+				if (field == article_field::url && capture.text.empty()) {
+					get_xml_attr_value (xml_node, "href", capture.href);
+				}
 
-				article = &feed_lines.back();
+				store_field_capture (capture, feed_lines[article_index]);
 			}
 
-			std::string attr_value;
-			std::string_view text = (char*) xmlNodeGetContent (xml_node);
+			parse_rss_feed (xml_node->children, feed_lines, article_index);
+		}
 
-			if (article && node_name == "title") {
-				article->headline = text;
-			} else if (article && node_name == "link") {
-				//Some feed formats use an href attribute for the link
-				if (text.empty() && xml_node->properties) {
+		return;
+	}
 
-					get_xml_attr_value (xml_node, "href", attr_value);
+	/*
+		Appends the text of xml_node, its siblings and their subtrees. Same result as xmlNodeGetContent without the allocation.
+	*/
+	void
+	append_node_text (xmlNode* xml_node, std::string& text)
+	{
+		for (; xml_node; xml_node = xml_node->next) {
+			switch (xml_node->type) {
+				case XML_TEXT_NODE:
+				case XML_CDATA_SECTION_NODE:
+					if (xml_node->content) {
+						text.append ((const char*) (xml_node->content));
+					}
 
-					text = attr_value;
-				}
+					break;
 
-				article->url = text;
-			} else if (article && (node_name == "pubdate" ||
-			                       node_name == "published" ||
-			                       node_name == "updated" ||
-			                       node_name == "date")) {
-				article->article_date = text;
-			} else if (article && (node_name == "description" ||
-			                       node_name == "summary")) {
-				article->article_summary = text;
-			} else if (article && (node_name == "content" ||
-			                       node_name == "encoded")) {
-				article->article_text = article->article_text + std::string (text);
-			}
+				case XML_ELEMENT_NODE:
+					append_node_text (xml_node->children, text);
+					break;
+
+				case XML_ENTITY_REF_NODE: {
+						xmlEntity* entity = xmlGetDocEntity (xml_node->doc, xml_node->name);
+
+						if (entity) {
+							append_node_text (entity->children, text);
+						}
+					}
+					break;
 
-			parse_rss_feed (xml_node->children, feed_lines, article);
+				default:
+					break;
+			}
 		}
 
 		return;
@@ -123,38 +355,363 @@ namespace {
 	void
 	get_xml_attr_value (xmlNode* xml_node, std::string_view attr_name, std::string& value)
 	{
-		if (xml_node->properties) {
-			xmlAttr* attr = nullptr;
+		for (xmlAttr* attr = xml_node->properties; attr; attr = attr->next) {
+			if (attr_name == (const char*) (attr->name)) {
+				append_node_text (attr->children, value);
 
-			for (attr = xml_node->properties; attr; attr = attr->next) {
-				std::string name;
+				break;
+			}
+		}
 
-				if (attr_name.empty() == false) {
-					std::stringstream xml_text;
+		return;
+	}
 
-					xml_text << attr->name;
+	/*
+		STREAMING PARSE
 
-					name = xml_text.str();
+		Parsed with SAX2 callbacks so no tree is built. A recognized element that is still open
+		is a field_capture collecting its text.
+	*/
+	struct feed_stream_state
+	{
+		public:
+			std::vector<gautier_rss_data_read::rss_article>* feed_lines = nullptr;
+			bool has_article = false;
+			int depth = 0;
+			std::vector<field_capture> captures;
+	};
+
+	void
+	on_start_element (void* context, const xmlChar* local_name, const xmlChar* /*prefix*/, const xmlChar* /*uri*/,
+	                  int /*namespace_count*/, const xmlChar** /*namespaces*/,
+	                  int attribute_count, int /*defaulted_count*/, const xmlChar** attributes)
+	{
+		feed_stream_state* state = (feed_stream_state*) (context);
+
+		state->depth++;
+
+		std::vector<gautier_rss_data_read::rss_article>& feed_lines = *state->feed_lines;
+
+		const article_field field = get_article_field ((const char*) (local_name));
+
+		if (field == article_field::article) {
+			feed_lines.emplace_back (gautier_rss_data_read::rss_article());
+
+			state->has_article = true;
+
+			return;
+		}
+
+		if (state->has_article == false || field == article_field::none) {
+			return;
+		}
+
+		field_capture capture;
+
+		capture.field = field;
+		capture.article_index = feed_lines.size() - 1;
+		capture.depth = state->depth;
+
+		/*
+			Attributes arrive as (local name, prefix, uri, value, value end) tuples.
+			Unless entities are substituted the parser keeps & in attribute values as &#38;
+		*/
+		for (int attribute_index = 0; field == article_field::url && attribute_index < attribute_count; attribute_index++) {
+			const xmlChar** attribute = attributes + (attribute_index * 5);
+
+			if (std::strcmp ((const char*) (attribute[0]), "href") == 0) {
+				std::string_view value ((const char*) (attribute[3]), (size_t) (attribute[4] - attribute[3]));
+
+				for (size_t ref_index = value.find ("&#38;"); ref_index != std::string_view::npos;
+				        ref_index = value.find ("&#38;")) {
+					capture.href.append (value.substr (0, ref_index));
+					capture.href.push_back ('&');
+
+					value.remove_prefix (ref_index + 5);
 				}
 
-				;
+				capture.href.append (value);
+
+				break;
+			}
+		}
 
-				if (name == attr_name) {
-					std::stringstream xml_text;
+		state->captures.emplace_back (std::move (capture));
 
-					xml_text << xmlNodeGetContent (attr->children);
+		return;
+	}
 
-					value = xml_text.str();
+	void
+	on_end_element (void* context, const xmlChar* /*local_name*/, const xmlChar* /*prefix*/, const xmlChar* /*uri*/)
+	{
+		feed_stream_state* state = (feed_stream_state*) (context);
 
-					break;
+		std::vector<field_capture>& captures = state->captures;
+
+		if (captures.empty() == false && captures.back().depth == state->depth) {
+			field_capture& capture = captures.back();
+
+			store_field_capture (capture, (*state->feed_lines)[capture.article_index]);
+
+			captures.pop_back();
+		}
+
+		state->depth--;
+
+		return;
+	}
+
+	void
+	on_characters (void* context, const xmlChar* chars, int char_count)
+	{
+		feed_stream_state* state = (feed_stream_state*) (context);
+
+		for (field_capture& capture : state->captures) {
+			capture.text.append ((const char*) (chars), (size_t) (char_count));
+		}
+
+		return;
+	}
+
+	/*
+		LIBXML2 SETUP
+
+		libxml2 is initialized once per process and its global state is kept until the process ends.
+		xmlCleanupParser is never called, since it would pull that state out from under a parse
+		running on another thread.
+
+		Parser contexts are pooled per thread and reused from feed to feed. Each context looks names
+		up in a sub dictionary of shared_names. shared_names is filled with the common feed names
+		during setup and only read after that, so every thread can use it without a lock.
+	*/
+	std::once_flag
+	libxml_setup_flag;
+
+	xmlDict*
+	shared_names = nullptr;
+
+	/*
+		A context whose own dictionary grows past this many names is freed rather than reused.
+	*/
+	const int
+	max_context_dict_names = 4096;
+
+	struct parser_context_pool
+	{
+		public:
+			std::vector<xmlParserCtxt*> stream_contexts;
+			std::vector<xmlParserCtxt*> document_contexts;
+
+			~parser_context_pool()
+			{
+				for (xmlParserCtxt* parser_context : stream_contexts) {
+					xmlFreeParserCtxt (parser_context);
+				}
+
+				for (xmlParserCtxt* parser_context : document_contexts) {
+					xmlFreeParserCtxt (parser_context);
 				}
 			}
+	};
+
+	thread_local parser_context_pool
+	context_pool;
+
+	void
+	setup_libxml()
+	{
+		std::call_once (libxml_setup_flag, []() {
+			/*
+			 * this initialize the library and check potential ABI mismatches
+			 * between the version it was compiled for and the actual shared
+			 * library used.
+			 */
+			LIBXML_TEST_VERSION
+
+			xmlInitParser();
+
+			shared_names = xmlDictCreate();
+
+			const std::string_view common_names[] = {
+				"xml", "xmlns", "rss", "channel", "feed", "version", "href", "rel", "type", "guid", "author",
+				"name", "email", "category", "comments", "enclosure", "id", "creator", "div", "p", "a", "br"
+			};
+
+			for (const std::string_view name : common_names) {
+				xmlDictLookup (shared_names, (const xmlChar*) (name.data()), (int) (name.size()));
+			}
+
+			for (const element_name& entry : element_names) {
+				xmlDictLookup (shared_names, (const xmlChar*) (entry.name.data()), (int) (entry.name.size()));
+			}
+		});
+
+		return;
+	}
+
+	/*
+		Swaps the private dictionary a new context starts with for a sub dictionary of shared_names.
+		The reset that follows interns the context's own strings in the new dictionary.
+	*/
+	void
+	use_shared_names (xmlParserCtxt* parser_context)
+	{
+		xmlDictFree (parser_context->dict);
+
+		parser_context->dict = xmlDictCreateSub (shared_names);
+
+		return;
+	}
+
+	xmlParserCtxt*
+	acquire_stream_context (feed_stream_state* sax_state)
+	{
+		setup_libxml();
+
+		std::vector<xmlParserCtxt*>& stream_contexts = context_pool.stream_contexts;
+
+		xmlParserCtxt* parser_context = nullptr;
+
+		if (stream_contexts.empty() == false) {
+			parser_context = stream_contexts.back();
+
+			stream_contexts.pop_back();
+		} else {
+			xmlSAXHandler sax_handler;
+
+			std::memset (&sax_handler, 0, sizeof (sax_handler));
+
+			sax_handler.initialized = XML_SAX2_MAGIC;
+			sax_handler.startElementNs = on_start_element;
+			sax_handler.endElementNs = on_end_element;
+			sax_handler.characters = on_characters;
+			sax_handler.ignorableWhitespace = on_characters;
+			sax_handler.cdataBlock = on_characters;
+
+			parser_context = xmlCreatePushParserCtxt (&sax_handler, nullptr, nullptr, 0, nullptr);
+
+			if (parser_context == nullptr) {
+				return nullptr;
+			}
+
+			use_shared_names (parser_context);
+		}
+
+		xmlCtxtResetPush (parser_context, nullptr, 0, nullptr, nullptr);
+
+		xmlCtxtUseOptions (parser_context, XML_PARSE_RECOVER | XML_PARSE_NONET);
+
+		parser_context->userData = sax_state;
+
+		return parser_context;
+	}
+
+	xmlParserCtxt*
+	acquire_document_context()
+	{
+		setup_libxml();
+
+		std::vector<xmlParserCtxt*>& document_contexts = context_pool.document_contexts;
+
+		xmlParserCtxt* parser_context = nullptr;
+
+		if (document_contexts.empty() == false) {
+			parser_context = document_contexts.back();
+
+			document_contexts.pop_back();
+		} else {
+			parser_context = xmlNewParserCtxt();
+
+			if (parser_context) {
+				use_shared_names (parser_context);
+
+				xmlCtxtReset (parser_context);
+			}
+		}
+
+		return parser_context;
+	}
+
+	void
+	release_parser_context (std::vector<xmlParserCtxt*>& parser_contexts, xmlParserCtxt* parser_context)
+	{
+		if (xmlDictSize (parser_context->dict) > max_context_dict_names) {
+			xmlFreeParserCtxt (parser_context);
+		} else {
+			parser_contexts.push_back (parser_context);
 		}
 
 		return;
 	}
 }
 
+/*
+	STREAMING PARSE SESSION
+
+	Feed text can be written in pieces of any size, such as the blocks received from the network.
+*/
+struct gautier_rss_data_parse::feed_parse_stream_state
+{
+	public:
+		xmlParserCtxt* parser_context = nullptr;
+		feed_stream_state sax_state;
+};
+
+bool
+gautier_rss_data_parse::open_feed_parse_stream (std::vector<gautier_rss_data_read::rss_article>& feed_lines,
+        feed_parse_stream& parse_stream)
+{
+	feed_parse_stream_state* state = new feed_parse_stream_state();
+
+	state->sax_state.feed_lines = &feed_lines;
+
+	state->parser_context = acquire_stream_context (&state->sax_state);
+
+	if (state->parser_context == nullptr) {
+		delete state;
+
+		return false;
+	}
+
+	parse_stream.state = state;
+
+	return true;
+}
+
+bool
+gautier_rss_data_parse::write_feed_parse_stream (feed_parse_stream& parse_stream, std::string_view feed_data)
+{
+	feed_parse_stream_state* state = parse_stream.state;
+
+	if (state == nullptr) {
+		return false;
+	}
+
+	if (feed_data.empty() == false) {
+		xmlParseChunk (state->parser_context, feed_data.data(), (int) (feed_data.size()), 0);
+	}
+
+	return true;
+}
+
+void
+gautier_rss_data_parse::close_feed_parse_stream (feed_parse_stream& parse_stream)
+{
+	feed_parse_stream_state* state = parse_stream.state;
+
+	if (state) {
+		xmlParseChunk (state->parser_context, nullptr, 0, 1);
+
+		release_parser_context (context_pool.stream_contexts, state->parser_context);
+
+		delete state;
+
+		parse_stream.state = nullptr;
+	}
+
+	return;
+}
+
 /*
 	RSS FEED READER
 
@@ -169,38 +726,105 @@ namespace {
 void
 gautier_rss_data_parse::get_feed_lines (std::string_view feed_data,
                                         std::vector<gautier_rss_data_read::rss_article>& feed_lines)
+{
+	get_feed_lines (feed_data, feed_lines, feed_parse_mode::stream);
+
+	return;
+}
+
+void
+gautier_rss_data_parse::get_feed_lines (std::string_view feed_data,
+                                        std::vector<gautier_rss_data_read::rss_article>& feed_lines,
+                                        const feed_parse_mode parse_mode)
 {
 	xmlDoc* doc = nullptr;
 	xmlNode* root_element = nullptr;
 
-	/*
-	 * this initialize the library and check potential ABI mismatches
-	 * between the version it was compiled for and the actual shared
-	 * library used.
-	 */
-	LIBXML_TEST_VERSION
-
 	/*parse the file and get the DOM */
 	const size_t feed_data_size = feed_data.size();
 
-	if (feed_data.empty() == false) {
-		doc = xmlRecoverMemory (feed_data.data(), (int) (feed_data_size));
+	if (feed_data.empty() == false && parse_mode == feed_parse_mode::stream) {
+		feed_parse_stream parse_stream;
+
+		if (open_feed_parse_stream (feed_lines, parse_stream)) {
+			/*
+				The text is handed to the parser in pieces so libxml2 never holds a copy of the whole feed.
+			*/
+			const size_t chunk_size = 65536;
 
-		if (doc) {
-			/*Get the root element node */
-			root_element = xmlDocGetRootElement (doc);
+			while (feed_data.empty() == false) {
+				const size_t char_count = std::min (chunk_size, feed_data.size());
 
-			parse_rss_feed (root_element, feed_lines, nullptr);
+				write_feed_parse_stream (parse_stream, feed_data.substr (0, char_count));
 
-			/*free the document */
-			xmlFreeDoc (doc);
+				feed_data.remove_prefix (char_count);
+			}
+
+			close_feed_parse_stream (parse_stream);
 		}
+	} else if (feed_data.empty() == false) {
+		xmlParserCtxt* parser_context = acquire_document_context();
 
-		/*
-		 *Free the global variables that may
-		 *have been allocated by the parser.
-		 */
-		xmlCleanupParser();
+		if (parser_context) {
+			doc = xmlCtxtReadMemory (parser_context, feed_data.data(), (int) (feed_data_size), nullptr, nullptr,
+			                         XML_PARSE_RECOVER);
+
+			if (doc) {
+				/*Get the root element node */
+				root_element = xmlDocGetRootElement (doc);
+
+				parse_rss_feed (root_element, feed_lines, no_article);
+
+				/*free the document */
+				xmlFreeDoc (doc);
+			}
+
+			release_parser_context (context_pool.document_contexts, parser_context);
+		}
+	}
+
+	return;
+}
+
+/*
+	PARALLEL PARSE
+
+	Workers take the next unparsed feed until none are left, so a few large feeds do not hold up the rest.
+	The calling thread is one of the workers.
+*/
+void
+gautier_rss_data_parse::parse_many_feeds (const std::vector<std::string_view>& feed_data,
+        std::vector<std::vector<gautier_rss_data_read::rss_article>>& feed_lines,
+        const feed_parse_mode parse_mode, size_t worker_count)
+{
+	const size_t feed_count = feed_data.size();
+
+	feed_lines.resize (feed_count);
+
+	if (worker_count == 0) {
+		worker_count = std::max<size_t> (1, std::thread::hardware_concurrency());
+	}
+
+	worker_count = std::min (worker_count, feed_count);
+
+	std::atomic_size_t next_feed_index = 0;
+
+	auto parse_feeds = [&feed_data, &feed_lines, &next_feed_index, feed_count, parse_mode]() {
+		for (size_t feed_index = next_feed_index++; feed_index < feed_count; feed_index = next_feed_index++) {
+			get_feed_lines (feed_data[feed_index], feed_lines[feed_index], parse_mode);
+		}
+	};
+
+	std::vector<std::thread> workers;
+
+	for (size_t worker_index = 1; worker_index < worker_count; worker_index++) {
+		workers.emplace_back (parse_feeds);
+	}
+
+	parse_feeds();
+
+	for (std::thread& worker : workers) {
+		worker.join();
 	}
 
 	return;
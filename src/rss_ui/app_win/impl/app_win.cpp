@@ -51,6 +51,10 @@ namespace {
 		void manage_feeds_click (GtkButton * button, gpointer user_data);
 		void rss_operation_click (GtkButton * button, gpointer user_data);
 
+		void search_entry_activate (GtkEntry * entry, gpointer user_data);
+		void search_more_click (GtkButton * button, gpointer user_data);
+		void search_result_activate (GtkListBox * list_box, GtkListBoxRow * row, gpointer user_data);
+
 		void select_headline_row (GtkTreeSelection * tree_selection, gpointer user_data);
 
 		void window_size_allocate (GtkWidget * widget, GdkRectangle * allocation, gpointer user_data);
@@ -84,6 +88,18 @@ namespace {
 	GtkWidget*
 	manage_feeds_button = nullptr;
 
+	GtkWidget*
+	search_entry = nullptr;
+
+	GtkWidget*
+	search_popover = nullptr;
+
+	GtkWidget*
+	search_results_list = nullptr;
+
+	GtkWidget*
+	search_more_button = nullptr;
+
 	GtkWindow*
 	win = nullptr;
 
@@ -191,6 +207,13 @@ namespace {
 	ns_data_read::rss_article
 	visible_feed_article;
 
+	/*
+		Search result shown in the article frame.
+		Empty while the article frame shows the article of the visible tab.
+	*/
+	ns_data_read::rss_article
+	search_article;
+
 	/*RSS Configuration Updates*/
 
 	void
@@ -209,6 +232,23 @@ namespace {
 	void
 	make_user_note (std::string note);
 
+	/*
+		Article Search
+
+		Results are shown in a popover under the search box one page at a time.
+	*/
+	void
+	show_search_results_page();
+
+	ns_data_read::articles_list_type
+	search_results;
+
+	std::string
+	search_text_active;
+
+	const int64_t
+	search_page_size = 50;
+
 	rss_operation_enum
 	rss_op_view_article = rss_operation_enum::view_article;
 
@@ -388,6 +428,8 @@ namespace {
 
 			visible_feed_article = feed_article_selection[feed_name];
 
+			search_article = ns_data_read::rss_article();
+
 			/*
 				Immediately designate feed name for row_select signal.
 					Value of current_page is modified *after* signal handler returns.
@@ -459,6 +501,8 @@ namespace {
 				make_user_note (feed_name + " feed last updated " + date_status);
 			}
 
+			search_article = ns_data_read::rss_article();
+
 			show_article (visible_feed_article);
 		}
 
@@ -524,10 +568,13 @@ namespace {
 		if (button) {
 			rss_operation_enum operation = * (rss_operation_enum*)user_data;
 
-			if (operation == rss_operation_enum::view_article && visible_feed_article.url.empty() == false) {
-				make_user_note ("Viewing " + visible_feed_article.feed_name + " in web browser");
+			const ns_data_read::rss_article& article = search_article.headline.empty() ? visible_feed_article :
+			        search_article;
 
-				gtk_show_uri_on_window (win, visible_feed_article.url.data(), GDK_CURRENT_TIME, nullptr);
+			if (operation == rss_operation_enum::view_article && article.url.empty() == false) {
+				make_user_note ("Viewing " + article.feed_name + " in web browser");
+
+				gtk_show_uri_on_window (win, article.url.data(), GDK_CURRENT_TIME, nullptr);
 			}
 		}
 
@@ -554,6 +601,116 @@ namespace {
 		return;
 	}
 
+	/*
+		Article Search
+	*/
+	void
+	search_entry_activate (GtkEntry* entry,
+	                       gpointer  user_data)
+	{
+		if (entry) {
+			if (user_data) {
+				std::cout << __func__ << " called with user_data\n";
+			}
+
+			search_text_active = gtk_entry_get_text (entry);
+
+			search_results.clear();
+
+			GList* rows = gtk_container_get_children (GTK_CONTAINER (search_results_list));
+
+			for (GList* row = rows; row != nullptr; row = row->next) {
+				gtk_widget_destroy (GTK_WIDGET (row->data));
+			}
+
+			g_list_free (rows);
+
+			if (search_text_active.empty() == false) {
+				show_search_results_page();
+
+				gtk_popover_popup (GTK_POPOVER (search_popover));
+			}
+		}
+
+		return;
+	}
+
+	void
+	search_more_click (GtkButton* button,
+	                   gpointer   user_data)
+	{
+		if (button) {
+			if (user_data) {
+				std::cout << __func__ << " called with user_data\n";
+			}
+
+			show_search_results_page();
+		}
+
+		return;
+	}
+
+	void
+	search_result_activate (GtkListBox*    list_box,
+	                        GtkListBoxRow* row,
+	                        gpointer       user_data)
+	{
+		if (list_box && row) {
+			if (user_data) {
+				std::cout << __func__ << " called with user_data\n";
+			}
+
+			const gint row_index = gtk_list_box_row_get_index (row);
+
+			if (row_index > -1 && (size_t) (row_index) < search_results.size()) {
+				const ns_data_read::rss_article article = search_results.at ((size_t) (row_index));
+
+				/*
+					The article of the visible tab is left as it is. View Article opens the search result.
+				*/
+				search_article = article;
+
+				show_article (article);
+
+				make_user_note (article.feed_name + " " + article.headline);
+			}
+		}
+
+		return;
+	}
+
+	void
+	show_search_results_page()
+	{
+		const std::string db_file_name = gautier_rss_ui_app::get_db_file_name();
+
+		const int64_t offset = (int64_t) (search_results.size());
+
+		ns_data_read::articles_list_type articles;
+
+		ns_data_read::search_articles (db_file_name, search_text_active, offset, search_page_size, articles);
+
+		for (const ns_data_read::rss_article& article : articles) {
+			const std::string result_text = article.feed_name + " - " + article.headline;
+
+			GtkWidget* result_label = gtk_label_new (result_text.data());
+			gtk_widget_set_halign (result_label, GTK_ALIGN_START);
+			gtk_label_set_ellipsize (GTK_LABEL (result_label), PANGO_ELLIPSIZE_END);
+
+			gtk_list_box_insert (GTK_LIST_BOX (search_results_list), result_label, -1);
+
+			search_results.emplace_back (article);
+		}
+
+		gtk_widget_set_sensitive (search_more_button, (int64_t) (articles.size()) == search_page_size);
+
+		gtk_widget_show_all (search_results_list);
+
+		make_user_note (std::to_string (search_results.size()) + " articles found for " + search_text_active);
+
+		return;
+	}
+
 	void
 	synchronize_feeds_to_configuration (std::map<std::string, ns_data_read::rss_feed_mod> feed_changes)
 	{
@@ -1302,6 +1459,12 @@ namespace {
 		std::string last_download_datetime = gautier_rss_util::get_current_date_time_utc();
 		std::string last_failed_download_datetime;
 
+		/*
+			Database upkeep runs in short slices while this thread waits between downloads.
+		*/
+		const int64_t maintenance_time_budget_in_milliseconds = 100;
+		bool maintenance_complete = false;
+
 		/*
 			Execution is signaled by download_running == true
 			When that condition changes, exit is defined in 3 key areas.
@@ -1380,6 +1543,11 @@ namespace {
 						std::cout << __func__ << ", LINE: " << __LINE__ << ";\t\t\tHOLD for " << wait_time_in_seconds << "s.\n";
 					}
 
+					if (maintenance_complete == false && download_available == false) {
+						maintenance_complete = ns_data_write::perform_db_maintenance (db_file_name,
+						                       maintenance_time_budget_in_milliseconds);
+					}
+
 					continue;
 				} else {
 					allow_process_output = true;
@@ -1556,6 +1724,8 @@ namespace {
 				download_available = (downloaded_feeds.size() > 0);
 
 				allow_process_output = false;
+
+				maintenance_complete = false;
 			}
 
 			download_in_progress = false;
@@ -1678,6 +1848,44 @@ gautier_rss_win_main::create (
 
 		gtk_container_add (GTK_CONTAINER (primary_function_buttons), view_article_button);
 		gtk_container_add (GTK_CONTAINER (primary_function_buttons), manage_feeds_button);
+
+		/*
+			Article Search
+		*/
+		search_entry = gtk_search_entry_new();
+		gautier_rss_ui_app::set_css_class (search_entry, "search_entry");
+
+		g_signal_connect (search_entry, "activate", G_CALLBACK (search_entry_activate), nullptr);
+
+		gtk_container_add (GTK_CONTAINER (primary_function_buttons), search_entry);
+
+		search_popover = gtk_popover_new (search_entry);
+		gtk_popover_set_position (GTK_POPOVER (search_popover), GTK_POS_TOP);
+		{
+			GtkWidget* search_layout = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+			gautier_rss_ui_app::set_css_class (search_layout, "inner_container");
+
+			GtkWidget* search_scroll = gtk_scrolled_window_new (nullptr, nullptr);
+			gtk_widget_set_size_request (search_scroll, monitor_width / 4, monitor_height / 3);
+
+			search_results_list = gtk_list_box_new();
+			gtk_list_box_set_activate_on_single_click (GTK_LIST_BOX (search_results_list), true);
+
+			g_signal_connect (search_results_list, "row-activated", G_CALLBACK (search_result_activate), nullptr);
+
+			search_more_button = gtk_button_new_with_label ("More Results");
+			gautier_rss_ui_app::set_css_class (search_more_button, "button");
+
+			g_signal_connect (search_more_button, "clicked", G_CALLBACK (search_more_click), nullptr);
+
+			gtk_container_add (GTK_CONTAINER (search_scroll), search_results_list);
+			gtk_box_pack_start (GTK_BOX (search_layout), search_scroll, true, true, 0);
+			gtk_box_pack_start (GTK_BOX (search_layout), search_more_button, false, false, 0);
+
+			gtk_container_add (GTK_CONTAINER (search_popover), search_layout);
+
+			gtk_widget_show_all (search_layout);
+		}
 	}
 
 	/*
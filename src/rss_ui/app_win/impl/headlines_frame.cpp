@@ -220,9 +220,14 @@ gautier_rss_win_main_headlines_frame::show_headlines (GtkWidget* headlines_view,
 
 			GtkTreeIter iter;
 
-			GtkTreeIter start_iter;
+			/*
+				Prepended rows are newly downloaded. They go above the rows already shown,
+				in the order given (newest publication date first), so the list keeps arrival order.
+				A new article with an older date is placed by date the next time the tab is loaded in full.
+			*/
+			GtkTreeIter previous_iter;
 
-			gboolean start_iter_is_valid = gtk_tree_model_get_iter_first (list_model, &start_iter);
+			bool previous_iter_is_valid = false;
 
 			for (int64_t i = range.first; i <= range.second && i < range_end; i++) {
 				const size_t headline_i = (size_t) (i);
@@ -234,8 +239,8 @@ gautier_rss_win_main_headlines_frame::show_headlines (GtkWidget* headlines_view,
 				/*
 					Adds a new row in the Tree Model.
 				*/
-				if (prepend && range.first > -1 && start_iter_is_valid) {
-					gtk_list_store_insert_before (list_store, &iter, &start_iter);
+				if (prepend && range.first > -1) {
+					gtk_list_store_insert_after (list_store, &iter, previous_iter_is_valid ? &previous_iter : nullptr);
 				} else {
 					gtk_list_store_append (list_store, &iter);
 				}
@@ -248,7 +253,8 @@ gautier_rss_win_main_headlines_frame::show_headlines (GtkWidget* headlines_view,
 				                    col_pos_stop);
 
 				if (prepend && range.first > -1) {
-					start_iter_is_valid = gtk_tree_model_get_iter_first (list_model, &start_iter);
+					previous_iter = iter;
+					previous_iter_is_valid = true;
 				}
 			}
 		}
@@ -10,12 +10,15 @@ You should have received a copy of the GNU Lesser General Public License along w
 Author: Michael Gautier <michaelgautier.wordpress.com>
 */
 
+#include <atomic>
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 
+#include "rss_lib/db/db.hpp"
 #include "rss_lib/rss/rss_util.hpp"
 #include "rss_lib/rss/rss_writer.hpp"
 
@@ -24,6 +27,7 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include "rss_ui/app_win/app_win.hpp"
 
 #include <gio/gio.h>
+#include <glib-unix.h>
 #include <sqlite3.h>
 
 /*
@@ -50,6 +54,11 @@ Author: Michael Gautier <michaelgautier.wordpress.com>
 #include <grp.h>
 #include <pwd.h>
 
+/*
+	- SIGUSR1 prints the SQL statement profiles while the program runs.
+*/
+#include <signal.h>
+
 namespace {
 	/*
 		- End all directory paths in this program with / to make concatenation trivial.
@@ -67,6 +76,15 @@ namespace {
 	const std::string
 	app_name = "michael.gautier.rss.v8";
 
+	/*
+		Expired articles are removed in the background so the window opens without waiting on it.
+	*/
+	std::thread
+	retention_thread;
+
+	std::atomic_bool
+	retention_stop_requested = false;
+
 	mode_t
 	get_read_write_filemask();
 
@@ -79,6 +97,9 @@ namespace {
 	void
 	load_application_icon();
 
+	gboolean
+	print_statement_profiles_on_signal (gpointer user_data);
+
 	int
 	create_directory (const std::string directory_path)
 	{
@@ -160,6 +181,18 @@ namespace {
 
 		return;
 	}
+
+	/*
+		Runs on the main loop, not in signal context. get_statement_profiles copies the
+		profiles under their lock, so statements on the write queue go on being timed.
+	*/
+	gboolean
+	print_statement_profiles_on_signal (gpointer /*user_data*/)
+	{
+		gautier_rss_database::print_statement_profiles();
+
+		return G_SOURCE_CONTINUE;
+	}
 }
 
 int
@@ -178,6 +211,13 @@ gautier_rss_ui_app::create()
 
 	load_application_icon();
 
+	/*
+		kill -USR1 <pid> prints the SQL statement profiles gathered so far.
+	*/
+	if (gautier_rss_database::is_statement_profiling_enabled()) {
+		g_unix_signal_add (SIGUSR1, print_statement_profiles_on_signal, nullptr);
+	}
+
 	status = g_application_run (G_APPLICATION (application), 0, nullptr);
 
 	/*
@@ -189,9 +229,19 @@ gautier_rss_ui_app::create()
 
 		const std::string db_file_name = get_db_file_name();
 		{
+			retention_stop_requested = true;
+
+			if (retention_thread.joinable()) {
+				retention_thread.join();
+			}
+
 			namespace ns_write = gautier_rss_data_write;
 			ns_write::de_initialize_db (db_file_name);
 		}
+
+		if (gautier_rss_database::is_statement_profiling_enabled()) {
+			gautier_rss_database::print_statement_profiles();
+		}
 	}
 
 	return status;
@@ -373,10 +423,28 @@ main (int argc, char** argv)
 
 		int sqlite_init_code = sqlite3_initialize();
 
+		/*
+			Set GAUTIERRSS_PROFILE_SQL=1 to time each SQL statement. The report is printed at exit and on SIGUSR1.
+		*/
+		const char* profile_sql = std::getenv ("GAUTIERRSS_PROFILE_SQL");
+
+		if (profile_sql && std::strcmp (profile_sql, "1") == 0) {
+			gautier_rss_database::set_statement_profiling (true);
+		}
+
 		if (sqlite_init_code == SQLITE_OK) {
 			gautier_rss_data_write::initialize_db (db_file_name);
 
-			gautier_rss_data_write::remove_expired_articles (db_file_name);
+			/*
+				Keeps disk writes off the download thread and the UI thread.
+			*/
+			const int64_t max_commit_delay_in_milliseconds = 100;
+
+			gautier_rss_data_write::start_write_queue (db_file_name, max_commit_delay_in_milliseconds);
+
+			retention_thread = std::thread ([db_file_name]() {
+				gautier_rss_data_write::remove_expired_articles (db_file_name, retention_stop_requested);
+			});
 		} else {
 			std::cout << "SQLite not initialized\n";
 		}